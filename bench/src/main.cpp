@@ -0,0 +1,464 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "ofMain.h"
+
+#include "Config.h"
+#include "SceneManager.h"
+#include "objects/Objects.h"
+#include "objects/Pixel.h"
+#include "options/Options.h"
+#include "OscOutboundPacketStream.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <thread>
+
+// dispatch benchmark: builds a synthetic scene tree & pushes property traffic
+// through the OscReceiver, either in-process, over loopback udp, or through a
+// shared memory ring, then reports throughput, send -> dispatch & send ->
+// apply latency, & main thread allocations
+
+// max number of distinct encoded messages, cycled through when sending more
+#define MAX_PACKETS 65536
+
+// how long to wait for the last udp or shared memory messages before giving up
+#define UDP_TIMEOUT_MS 1000
+
+// ALLOCATIONS
+
+static std::atomic<unsigned long long> numAllocations(0);
+static thread_local bool bCountAllocations = false; //< main thread only
+
+void* operator new(size_t size) {
+	if(bCountAllocations) {
+		numAllocations++;
+	}
+	void *p = malloc(size);
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+// TRAFFIC
+
+/// records how long ago each message was sent when dispatch reaches it,
+/// attached to the receiver first so it sees every message before the scenes,
+/// & when the receiver update which applied it returns
+class Probe : public OscObject {
+	public:
+		vector<uint64_t> latencies; //< send -> dispatch start in us, reserved up front
+		vector<uint64_t> sent; //< send times, reserved up front
+		vector<uint64_t> applyLatencies; //< send -> update end in us, reserved up front
+		
+		/// call after each receiver update
+		void applied() {
+			uint64_t now = oscMonotonicTime();
+			for(unsigned int i = applyLatencies.size(); i < sent.size(); ++i) {
+				applyLatencies.push_back(now - sent[i]);
+			}
+		}
+	protected:
+		bool processOscMessage(const OscMessage& message) {
+			if(message.getNumArgs() == 0) {
+				return false;
+			}
+			unsigned int last = message.getNumArgs()-1;
+			if(message.getArgType(last) == OFXOSC_TYPE_INT64) {
+				uint64_t time = message.getArgAsInt64(last);
+				latencies.push_back(oscMonotonicTime() - time);
+				sent.push_back(time);
+			}
+			return false;
+		}
+};
+
+/// counts the property updates it handles, the first rect in the first scene
+/// so the benchmark can check messages reach the scene objects
+class ProbeRectangle : public Rectangle {
+	public:
+		ProbeRectangle(const string &name) : Rectangle(name), numUpdates(0) {}
+		unsigned int numUpdates;
+	protected:
+		bool processOscMessage(const OscMessage& message) {
+			if(Rectangle::processOscMessage(message)) {
+				numUpdates++;
+				return true;
+			}
+			return false;
+		}
+};
+
+/// queues packets directly from the benchmark
+class InProcessListener : public OscListener {
+	public:
+		bool start() {return true;}
+		void stop() {}
+		bool isListening() {return false;}
+		string getName() {return "in-process";}
+		bool send(const char *data, unsigned int size) {
+			return queuePacket(data, size, endpoint);
+		}
+		osc::IpEndpointName endpoint;
+};
+
+/// an encoded message, the last 8 bytes are the send time
+typedef vector<char> Packet;
+
+/// write the send time into a packet, big endian
+static void stamp(Packet &packet) {
+	uint64_t now = oscMonotonicTime();
+	for(unsigned int i = 0; i < 8; ++i) {
+		packet[packet.size()-1-i] = (char)(now >> (i * 8));
+	}
+}
+
+/// a property message for an object type
+struct Traffic {
+	const char *address; //< appended to the object root
+	const char *args; //< f: float, i: int, s: string
+};
+
+/// an object type with the properties to send to it
+struct ObjectType {
+	const char *name;
+	vector<Traffic> properties;
+};
+
+/// the object types & their property traffic
+static vector<ObjectType> objectTypes() {
+	vector<ObjectType> types(7);
+	types[0].name = "rect";
+	types[0].properties = {{"/position", "ff"}, {"/size", "ff"}, {"/filled", "i"}, {"/color", "iiii"}};
+	types[1].name = "line";
+	types[1].properties = {{"/position1", "ff"}, {"/position2", "ff"}};
+	types[2].name = "pixel";
+	types[2].properties = {{"/position", "ff"}, {"/position/x", "f"}, {"/color/A", "i"}};
+	types[3].name = "text";
+	types[3].properties = {{"/position", "ff"}, {"/text", "s"}};
+	types[4].name = "bitmap";
+	types[4].properties = {{"/position", "ff"}, {"/size", "ff"}};
+	types[5].name = "image";
+	types[5].properties = {{"/position", "ff"}, {"/size", "ff"}};
+	types[6].name = "sprite";
+	types[6].properties = {{"/position", "ff"}, {"/size/width", "f"}};
+	return types;
+}
+
+/// create an object of a given type
+static DrawableObject* createObject(const string &type, const string &name) {
+	if(type == "rect")   {return new Rectangle(name);}
+	if(type == "line")   {return new Line(name);}
+	if(type == "pixel")  {return new Pixel(name);}
+	if(type == "text")   {return new Text(name);}
+	if(type == "bitmap") {return new Bitmap(name, 8, 8);}
+	if(type == "image")  {return new Image(name);}
+	return new Sprite(name);
+}
+
+/// encode the traffic, round robin over the objects & their properties,
+/// only addressing the first scene unless spread is set
+static void encodeTraffic(vector<Packet> &packets, unsigned int count,
+                          unsigned int numScenes, unsigned int numObjects, bool spread) {
+	vector<ObjectType> types = objectTypes();
+	vector<char> buffer(OSC_MAX_PACKET_SIZE);
+	unsigned int objectsPerScene = numObjects * types.size();
+	packets.resize(count);
+	for(unsigned int i = 0; i < count; ++i) {
+		unsigned int object = i % objectsPerScene;
+		unsigned int scene = spread ? (i / objectsPerScene) % numScenes : 0;
+		const ObjectType &type = types[object % types.size()];
+		const Traffic &property = type.properties[(i / objectsPerScene) % type.properties.size()];
+		string address = Config::instance().baseAddress + "/scene" + ofToString(scene)
+			+ "/" + type.name + ofToString(object / types.size()) + property.address;
+		
+		osc::OutboundPacketStream p(&buffer[0], buffer.size());
+		p << osc::BeginMessage(address.c_str());
+		for(const char *a = property.args; *a; ++a) {
+			switch(*a) {
+				case 'f': p << (float)(i % 640); break;
+				case 'i': p << (osc::int32)(i % 2); break;
+				case 's': p << "hello"; break;
+			}
+		}
+		p << (osc::int64) 0 << osc::EndMessage; // send time
+		packets[i].assign(p.Data(), p.Data()+p.Size());
+	}
+}
+
+// RUNS
+
+/// queue a batch of packets, then update the receiver, like a frame's worth
+static void runInProcess(OscReceiver &receiver, Probe &probe, InProcessListener *listener,
+                         vector<Packet> &packets, unsigned int count, unsigned int batch) {
+	unsigned int sent = 0;
+	while(sent < count) {
+		for(unsigned int b = 0; b < batch && sent < count; ++b) {
+			Packet &packet = packets[sent % packets.size()];
+			stamp(packet);
+			if(!listener->send(&packet[0], packet.size())) {
+				break; // full
+			}
+			sent++;
+		}
+		receiver.update();
+		probe.applied();
+	}
+}
+
+/// update the receiver until everything has been dispatched, coalesced, or
+/// dropped, or nothing more arrives once sending has finished
+static void waitForDispatch(OscReceiver &receiver, Probe &probe, unsigned int count,
+                            std::atomic<bool> &bSending) {
+	uint64_t lastTime = oscMonotonicTime();
+	size_t lastCount = 0;
+	while(probe.latencies.size() + receiver.getNumCoalesced() +
+	      receiver.getNumDropped() + receiver.getNumSocketDropped() < count) {
+		receiver.update();
+		probe.applied();
+		uint64_t now = oscMonotonicTime();
+		if(probe.latencies.size() != lastCount || bSending) {
+			lastCount = probe.latencies.size();
+			lastTime = now;
+		}
+		else if(now - lastTime > UDP_TIMEOUT_MS * 1000) {
+			break;
+		}
+	}
+}
+
+/// send from another thread over loopback udp, optionally at a fixed rate,
+/// while updating the receiver as fast as possible
+static void runUdp(OscReceiver &receiver, Probe &probe, vector<Packet> &packets,
+                   unsigned int count, unsigned int port, unsigned int rate) {
+	std::atomic<bool> bSending(true);
+	std::thread sender([&]() {
+		int s = socket(AF_INET, SOCK_DGRAM, 0);
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port = htons(port);
+		uint64_t start = oscMonotonicTime();
+		for(unsigned int i = 0; i < count; ++i) {
+			if(rate > 0) {
+				uint64_t due = start + (uint64_t) i * 1000000 / rate;
+				uint64_t now = oscMonotonicTime();
+				if(due > now) {
+					std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+				}
+			}
+			Packet &packet = packets[i % packets.size()];
+			stamp(packet);
+			sendto(s, &packet[0], packet.size(), 0, (struct sockaddr *) &address, sizeof(address));
+		}
+		close(s);
+		bSending = false;
+	});
+	
+	waitForDispatch(receiver, probe, count, bSending);
+	sender.join();
+}
+
+/// send from another thread through a shared memory ring, optionally at a fixed
+/// rate, while updating the receiver as fast as possible
+static void runShm(OscReceiver &receiver, Probe &probe, vector<Packet> &packets,
+                   unsigned int count, const string &name, unsigned int rate) {
+	std::atomic<bool> bSending(true);
+	std::thread sender([&]() {
+		OscShmRing ring;
+		if(!ring.open(name)) {
+			ofLogError() << "couldn't open shared memory \"" << name << "\"";
+			bSending = false;
+			return;
+		}
+		uint64_t start = oscMonotonicTime();
+		for(unsigned int i = 0; i < count; ++i) {
+			if(rate > 0) {
+				uint64_t due = start + (uint64_t) i * 1000000 / rate;
+				uint64_t now = oscMonotonicTime();
+				if(due > now) {
+					std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+				}
+			}
+			Packet &packet = packets[i % packets.size()];
+			stamp(packet);
+			while(!ring.write(&packet[0], packet.size())) {
+				std::this_thread::yield(); // full, the ring never drops
+			}
+		}
+		bSending = false;
+	});
+	waitForDispatch(receiver, probe, count, bSending);
+	sender.join();
+}
+
+//--------------------------------------------------------------
+int main(int argc, char *argv[]) {
+
+	Options options("  OSC dispatch benchmark", VERSION);
+	options.addInteger("SCENES", "s", "scenes", "Number of scenes (default: 10)");
+	options.addInteger("OBJECTS", "o", "objects", "Number of objects of each type per scene (default: 10)");
+	options.addInteger("MESSAGES", "n", "messages", "Number of messages to send (default: 1000000)");
+	options.addInteger("BATCH", "b", "batch", "In-process messages per receiver update (default: 256)");
+	options.addSwitch("UDP", "u", "udp", "Send over loopback UDP instead of in-process");
+	options.addInteger("PORT", "p", "port", "Loopback UDP port (default: 9990)");
+	options.addString("SHM", "", "shm", "Send through a shared memory ring with this name instead of in-process");
+	options.addInteger("RATE", "r", "rate", "Loopback UDP or shared memory messages/sec, 0 for as fast as possible (default: 0)");
+	options.addInteger("QUEUESIZE", "q", "queue-size", "Receiver queue size (default: 4096)");
+	options.addSwitch("SPREAD", "", "spread", "Address objects in all scenes, not only the current scene");
+	options.addSwitch("COALESCE", "", "coalesce", "Enable receiver coalescing");
+	if(!options.parse(argc, argv)) {
+		return EXIT_FAILURE;
+	}
+	unsigned int numScenes = options.isSet("SCENES") ? options.getUInt("SCENES") : 10;
+	unsigned int numObjects = options.isSet("OBJECTS") ? options.getUInt("OBJECTS") : 10;
+	unsigned int count = options.isSet("MESSAGES") ? options.getUInt("MESSAGES") : 1000000;
+	unsigned int batch = options.isSet("BATCH") ? options.getUInt("BATCH") : 256;
+	unsigned int port = options.isSet("PORT") ? options.getUInt("PORT") : 9990;
+	unsigned int rate = options.isSet("RATE") ? options.getUInt("RATE") : 0;
+	unsigned int queueSize = options.isSet("QUEUESIZE") ? options.getUInt("QUEUESIZE") : 4096;
+	bool bUdp = options.isSet("UDP");
+	string shmName = options.isSet("SHM") ? options.getString("SHM") : "";
+	if(numScenes == 0 || numObjects == 0 || count == 0 || batch == 0) {
+		ofLogError() << "scenes, objects, messages, & batch must be > 0";
+		return EXIT_FAILURE;
+	}
+	ofSetLogLevel(OF_LOG_WARNING);
+	
+	// synthetic scene tree
+	vector<ObjectType> types = objectTypes();
+	SceneManager sceneManager;
+	sceneManager.setOscRootAddress(Config::instance().baseAddress);
+	ProbeRectangle *probeRect = NULL;
+	for(unsigned int s = 0; s < numScenes; ++s) {
+		Scene *scene = new Scene("scene"+ofToString(s));
+		for(unsigned int o = 0; o < numObjects; ++o) {
+			for(unsigned int t = 0; t < types.size(); ++t) {
+				string name = types[t].name+ofToString(o);
+				if(s == 0 && o == 0 && t == 0) {
+					probeRect = new ProbeRectangle(name);
+					scene->addObject(probeRect);
+				}
+				else {
+					scene->addObject(createObject(types[t].name, name));
+				}
+			}
+		}
+		sceneManager.addScene(scene);
+	}
+	
+	// the manager only dispatches to the current scene, set it without
+	// setting it up as that loads resources & sets the background which
+	// needs a window
+	sceneManager.setCurrentScene(0);
+	
+	// receiver, the probe sees messages first
+	Probe probe;
+	probe.latencies.reserve(count);
+	probe.sent.reserve(count);
+	probe.applyLatencies.reserve(count);
+	OscReceiver receiver;
+	receiver.setQueueSize(std::max(queueSize, batch));
+	receiver.setCoalesce(options.isSet("COALESCE"));
+	receiver.addOscObject(&probe);
+	receiver.addOscObject(&sceneManager);
+	InProcessListener *listener = NULL;
+	if(bUdp) {
+		receiver.setup(port);
+		receiver.start();
+	}
+	else if(shmName != "") {
+		ofPtr<OscShmListener> shm(new OscShmListener(shmName));
+		shm->setQueueSize(std::max(queueSize, batch));
+		if(!shm->start()) {
+			return EXIT_FAILURE;
+		}
+		receiver.addListener(shm);
+	}
+	else {
+		listener = new InProcessListener;
+		listener->setQueueSize(std::max(queueSize, batch));
+		receiver.addListener(ofPtr<OscListener>(listener));
+	}
+	
+	vector<Packet> packets;
+	encodeTraffic(packets, std::min(count, (unsigned int) MAX_PACKETS),
+	              numScenes, numObjects, options.isSet("SPREAD"));
+	
+	cout << "scenes: " << numScenes << ", objects per scene: "
+	     << numObjects * types.size() << ", messages: " << count
+	     << (bUdp ? ", loopback udp" : (shmName != "" ? ", shared memory" : ", in-process")) << endl;
+	
+	// run, only counting allocations made on the dispatching thread
+	numAllocations = 0;
+	bCountAllocations = true;
+	uint64_t start = oscMonotonicTime();
+	if(bUdp) {
+		runUdp(receiver, probe, packets, count, port, rate);
+	}
+	else if(shmName != "") {
+		runShm(receiver, probe, packets, count, shmName, rate);
+	}
+	else {
+		runInProcess(receiver, probe, listener, packets, count, batch);
+	}
+	uint64_t elapsed = oscMonotonicTime() - start;
+	bCountAllocations = false;
+	receiver.stop();
+	
+	// report
+	vector<uint64_t> &latencies = probe.latencies;
+	unsigned int dispatched = latencies.size();
+	if(dispatched == 0) {
+		ofLogError() << "no messages were dispatched";
+		return EXIT_FAILURE;
+	}
+	if(probeRect->numUpdates == 0) {
+		ofLogError() << "no messages reached the scene objects";
+		return EXIT_FAILURE;
+	}
+	std::sort(latencies.begin(), latencies.end());
+	vector<uint64_t> &applyLatencies = probe.applyLatencies;
+	std::sort(applyLatencies.begin(), applyLatencies.end());
+	cout << "dispatched: " << dispatched
+	     << ", dropped: " << receiver.getNumDropped() + receiver.getNumSocketDropped()
+	     << ", coalesced: " << receiver.getNumCoalesced() << endl;
+	cout << "time: " << elapsed / 1000.0 << " ms" << endl;
+	cout << "messages/sec: " << (unsigned long long)(dispatched * 1000000.0 / elapsed) << endl;
+	cout << "dispatch latency us (send -> dispatch start): p50 " << latencies[dispatched / 2]
+	     << ", p99 " << latencies[(unsigned int)(dispatched * 0.99)]
+	     << ", max " << latencies.back() << endl;
+	cout << "apply latency us (send -> applying update end): p50 " << applyLatencies[dispatched / 2]
+	     << ", p99 " << applyLatencies[(unsigned int)(dispatched * 0.99)]
+	     << ", max " << applyLatencies.back() << endl;
+	cout << "allocations/msg: " << (double) numAllocations / dispatched << endl;
+	
+	return EXIT_SUCCESS;
+}
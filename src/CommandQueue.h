@@ -0,0 +1,77 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include <string>
+#include <deque>
+
+/// a deferred scene transport or script command
+struct Command {
+
+	enum Type {
+		NONE,          //< do nothing
+		GOTO_SCENE,    //< go to a scene by name, or by index if >= 0
+		NEXT_SCENE,
+		PREV_SCENE,
+		FOLLOW_SCENE,  //< go to a scene by name & slideshow object if >= 0,
+		               //< following another instance
+		LOAD_SCRIPT,   //< load a script by path
+		RELOAD_SCRIPT,
+		EXIT           //< quit the app
+	};
+	
+	Command(Type type=NONE, const std::string &name="", int index=-1) :
+		type(type), name(name), index(index) {}
+	
+	/// does this command setup scenes or load resources, ie. counts toward
+	/// the per frame setup budget?
+	bool isSetup() const {return type != NONE && type != EXIT;}
+	
+	Type type;
+	std::string name; //< scene name or script path
+	int index; //< scene index, -1 to use the name, or slideshow object when following
+};
+
+/// commands queued by osc messages & key presses, executed in order at the
+/// start of the next update so scene & script setup happens at one point in
+/// the frame where it can be measured & budgeted
+///
+/// main thread only, osc messages are dispatched from the receiver update
+class CommandQueue {
+
+	public:
+	
+		void push(const Command &command) {commands.push_back(command);}
+		
+		/// the next command, check empty() first
+		const Command& front() const {return commands.front();}
+		void pop() {commands.pop_front();}
+		
+		bool empty() const {return commands.empty();}
+		unsigned int size() const {return commands.size();}
+		void clear() {commands.clear();}
+	
+	protected:
+	
+		std::deque<Command> commands;
+};
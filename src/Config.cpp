@@ -29,15 +29,22 @@
 //--------------------------------------------------------------
 Config::Config() :
 	script(""), isPlaylist(false), playlist(""),
-	listeningPort(9990),
+	listeningPort(9990), tcpListeningPort(0), shmName(""), shmSize(1048576),
+	oscQueueSize(1024), oscCoalesce(false),
+	oscReceiveBufferSize(0), oscRecordFile(""), oscReplayFile(""), oscReplayFast(false),
+	oscLatencyStats(false), oscTrafficStats(false), oscStatsInterval(0),
+	oscBacklogSize(1024), oscBacklogTriggers(256), oscBacklogDropNewest(false),
+	oscMirror(false), oscMirrorRate(30),
 	sendingIp("127.0.0.1"), sendingPort(8880),
+	oscSendInterval(0), oscSendImmediate(false), oscMaxBundleSize(1400),
 	baseAddress((string) "/"+PACKAGE),
 	notificationAddress(baseAddress+"/notifications"),
 	deviceAddress(baseAddress+"/devices"),
 	connectionId(0),
+	syncMode(""), syncGroup("239.255.86.1"), syncPort(9980), syncMaxSkew(40),
 	fontFilename(""),
 	renderWidth(0), renderHeight(0), fullscreen(false),
-	setupAllScenes(true), showSceneNames(true) {}
+	setupAllScenes(true), showSceneNames(true), setupBudget(0) {}
 
 // PUBLIC
 //--------------------------------------------------------------
@@ -53,6 +60,31 @@ bool Config::parseCommandLine(int argc, char **argv) {
 	options.addInteger("PORT", "p", "port", "IP address to send to (default: 8880)");
 	options.addString("LISTENPORT", "l", "listening-port", "IP address to send to (default: 9990)");
 	options.addInteger("CONNECTID", "c", "connection-id", "Connection id for notifications (default: 0)");
+	options.addInteger("TCPPORT", "", "tcp-port", "OSC SLIP over TCP listening port (default: none)");
+	options.addString("SHM", "", "shm", "Shared memory ring name for same host OSC senders, ie. /visual (default: none)");
+	options.addInteger("SHMSIZE", "", "shm-size", "Shared memory ring size in bytes (default: 1048576)");
+	options.addString("LISTENERS", "", "listeners", "Extra OSC listening ports with optional address subtrees, ie. 9991:/visual/lights,9992");
+	options.addInteger("QUEUESIZE", "q", "queue-size", "Max OSC messages queued between frames (default: 1024)");
+	options.addInteger("RECVBUFFER", "", "recv-buffer", "OSC socket receive buffer size in bytes, Linux only (default: system)");
+	options.addSwitch("COALESCE", "", "coalesce", "Only apply the newest OSC message per address each frame");
+	options.addString("RECORD", "", "record", "Record received OSC to a log file");
+	options.addString("REPLAY", "", "replay", "Replay an OSC log file in real time");
+	options.addSwitch("REPLAYFAST", "", "replay-fast", "Replay the OSC log file as fast as possible");
+	options.addSwitch("LATENCY", "", "latency", "Collect OSC input to photon latency stats");
+	options.addSwitch("STATS", "", "stats", "Count OSC traffic & handler time per address prefix");
+	options.addInteger("STATSINTERVAL", "", "stats-interval", "Send OSC traffic stats notifications every N seconds (default: 0, never)");
+	options.addInteger("BACKLOG", "", "backlog", "Max OSC addresses held while paused, 0 to discard (default: 1024)");
+	options.addInteger("BACKLOGTRIGGERS", "", "backlog-triggers", "Max OSC triggers held while paused (default: 256)");
+	options.addSwitch("BACKLOGDROPNEW", "", "backlog-drop-newest", "Drop new OSC messages when the paused backlog is full instead of the oldest");
+	options.addSwitch("MIRROR", "", "mirror", "Send changed object properties each frame");
+	options.addInteger("MIRRORRATE", "", "mirror-rate", "Max mirrored sends per second per address, 0 for no limit (default: 30)");
+	options.addInteger("SENDINTERVAL", "", "send-interval", "Min ms between sent OSC bundles (default: 0, each frame)");
+	options.addSwitch("SENDIMMEDIATE", "", "send-immediate", "Send each OSC message right away instead of bundling per frame");
+	options.addInteger("BUNDLESIZE", "", "bundle-size", "Max sent OSC bundle size in bytes (default: 1400)");
+	options.addString("SYNC", "", "sync", "Frame sync with other instances as the \"leader\" or a \"follower\", instances need unique connection ids");
+	options.addString("SYNCGROUP", "", "sync-group", "Frame sync multicast group & port (default: 239.255.86.1:9980)");
+	options.addInteger("SYNCSKEW", "", "sync-skew", "Max frame sync skew in ms before jumping (default: 40)");
+	options.addInteger("SETUPBUDGET", "", "setup-budget", "Max ms of queued scene changes & script loads per frame, the rest wait for the next frame (default: 0, no limit)");
 	options.addSwitch("FULLSCREEN", "f", "fullscreen", "Start in fullscreen?");
 	options.addArgument("FILE", "  FILE \tOptional XML config file");
 	if(!options.parse(argc, argv)) {
@@ -70,6 +102,42 @@ bool Config::parseCommandLine(int argc, char **argv) {
 	if(options.isSet("PORT"))       {sendingPort = options.getUInt("PORT");}
 	if(options.isSet("LISTENPORT")) {listeningPort = options.getUInt("LISTENPORT");}
 	if(options.isSet("CONNECTID"))  {connectionId = options.getInt("CONNECTID");}
+	if(options.isSet("TCPPORT"))    {tcpListeningPort = options.getUInt("TCPPORT");}
+	if(options.isSet("SHM"))        {shmName = options.getString("SHM");}
+	if(options.isSet("SHMSIZE"))    {shmSize = options.getUInt("SHMSIZE");}
+	if(options.isSet("LISTENERS"))  {parseListeners(options.getString("LISTENERS"));}
+	if(options.isSet("QUEUESIZE"))  {oscQueueSize = options.getUInt("QUEUESIZE");}
+	if(options.isSet("RECVBUFFER")) {oscReceiveBufferSize = options.getUInt("RECVBUFFER");}
+	if(options.isSet("COALESCE"))   {oscCoalesce = true;}
+	if(options.isSet("RECORD"))     {oscRecordFile = ofFilePath::getAbsolutePath(options.getString("RECORD"), false);}
+	if(options.isSet("REPLAY"))     {oscReplayFile = ofFilePath::getAbsolutePath(options.getString("REPLAY"), false);}
+	if(options.isSet("REPLAYFAST")) {oscReplayFast = true;}
+	if(options.isSet("LATENCY"))    {oscLatencyStats = true;}
+	if(options.isSet("STATS"))      {oscTrafficStats = true;}
+	if(options.isSet("STATSINTERVAL")) {oscStatsInterval = options.getUInt("STATSINTERVAL");}
+	if(options.isSet("BACKLOG"))         {oscBacklogSize = options.getUInt("BACKLOG");}
+	if(options.isSet("BACKLOGTRIGGERS")) {oscBacklogTriggers = options.getUInt("BACKLOGTRIGGERS");}
+	if(options.isSet("BACKLOGDROPNEW"))  {oscBacklogDropNewest = true;}
+	if(options.isSet("MIRROR"))        {oscMirror = true;}
+	if(options.isSet("MIRRORRATE"))    {oscMirrorRate = options.getUInt("MIRRORRATE");}
+	if(options.isSet("SENDINTERVAL"))  {oscSendInterval = options.getUInt("SENDINTERVAL");}
+	if(options.isSet("SENDIMMEDIATE")) {oscSendImmediate = true;}
+	if(options.isSet("BUNDLESIZE"))    {oscMaxBundleSize = options.getUInt("BUNDLESIZE");}
+	if(options.isSet("SYNC"))          {syncMode = options.getString("SYNC");}
+	if(options.isSet("SYNCGROUP"))     {
+		string group = options.getString("SYNCGROUP");
+		string::size_type colon = group.find(':');
+		syncGroup = group.substr(0, colon);
+		if(colon != string::npos) {
+			syncPort = ofToInt(group.substr(colon+1));
+		}
+	}
+	if(options.isSet("SYNCSKEW"))      {syncMaxSkew = options.getUInt("SYNCSKEW");}
+	if(syncMode != "" && syncMode != "leader" && syncMode != "follower") {
+		ofLogError(PACKAGE) << "unknown sync mode \"" << syncMode << "\", use leader or follower";
+		return false;
+	}
+	if(options.isSet("SETUPBUDGET"))   {setupBudget = options.getUInt("SETUPBUDGET");}
 	if(options.isSet("FULLSCREEN")) {fullscreen = true;}
 	return true;
 }
@@ -93,15 +161,47 @@ void Config::setup() {
 //--------------------------------------------------------------
 void Config::print() {
 	ofLogNotice() << "listening port: " << listeningPort;
+	if(tcpListeningPort > 0) {
+		ofLogNotice() << "tcp listening port: " << tcpListeningPort;
+	}
+	if(shmName != "") {
+		ofLogNotice() << "shm listener: " << shmName << " " << shmSize << " bytes";
+	}
+	for(unsigned int i = 0; i < listeners.size(); ++i) {
+		ofLogNotice() << "listener: " << listeners[i].port << " " << listeners[i].subtree;
+	}
+	ofLogNotice() << "osc queue size: " << oscQueueSize;
+	ofLogNotice() << "osc coalesce: " << oscCoalesce;
+	ofLogNotice() << "osc receive buffer size: " << oscReceiveBufferSize;
+	if(oscRecordFile != "") {
+		ofLogNotice() << "osc record file: " << oscRecordFile;
+	}
+	if(oscReplayFile != "") {
+		ofLogNotice() << "osc replay file: " << oscReplayFile << (oscReplayFast ? " (fast)" : "");
+	}
+	ofLogNotice() << "osc latency stats: " << oscLatencyStats;
+	ofLogNotice() << "osc traffic stats: " << oscTrafficStats;
+	ofLogNotice() << "osc stats interval: " << oscStatsInterval;
+	ofLogNotice() << "osc paused backlog: " << oscBacklogSize << " addresses, "
+		<< oscBacklogTriggers << " triggers, drop " << (oscBacklogDropNewest ? "newest" : "oldest");
+	ofLogNotice() << "osc mirror: " << oscMirror << " rate: " << oscMirrorRate;
 	ofLogNotice() << "sending ip: " << sendingIp;
 	ofLogNotice() << "sending port: " << sendingPort;
+	ofLogNotice() << "osc send interval: " << oscSendInterval;
+	ofLogNotice() << "osc send immediate: " << oscSendImmediate;
+	ofLogNotice() << "osc max bundle size: " << oscMaxBundleSize;
 	ofLogNotice() << "base address: " << baseAddress;
 	ofLogNotice() << "sending address for notifications: " << notificationAddress;
 	ofLogNotice() << "sending address for devices: " << deviceAddress;
 	ofLogNotice() << "connection id for notifications: " << connectionId;
+	if(syncMode != "") {
+		ofLogNotice() << "frame sync: " << syncMode << " " << syncGroup << ":" << syncPort
+			<< " max skew: " << syncMaxSkew << " ms";
+	}
 	ofLogNotice() << "render size: " << renderWidth << "x" << renderHeight;
 	ofLogNotice() << "setup all scenes: " << (setupAllScenes ? "true" : "false");
 	ofLogNotice() << "show scene names: " << (showSceneNames ? "true" : "false");
+	ofLogNotice() << "setup budget: " << setupBudget << " ms";
 }
 
 //--------------------------------------------------------------
@@ -121,15 +221,8 @@ void Config::setListeningPort(unsigned int port) {
 		return;
 	}
 	Config::instance().listeningPort = port;
-	OscReceiver &receiver = Config::instance().oscReceiver;
-	if(receiver.isListening()) {
-		receiver.stop();
-		receiver.setup(port);
-		receiver.start();
-	}
-	else {
-		receiver.setup(port);
-	}
+	// only restarts the default listener, any others keep running
+	Config::instance().oscReceiver.setup(port);
 	ofLogNotice() << "listening port: " << port;
 }
 
@@ -162,7 +255,28 @@ void Config::setSendingPort(unsigned int port) {
 //--------------------------------------------------------------
 void Config::setBaseAddress(string base) {
 	baseAddress = base;
-	// make sure to update base objects ...
+	// make sure to update base objects, scenes & their objects follow
+	// the scene manager's root
 	app->setOscRootAddress(base);
 	app->sceneManager.setOscRootAddress(base);
+	app->setupOscTriggers();
+}
+
+// PRIVATE
+//--------------------------------------------------------------
+void Config::parseListeners(const string &list) {
+	vector<string> items = ofSplitString(list, ",", true, true);
+	for(unsigned int i = 0; i < items.size(); ++i) {
+		Listener listener;
+		string::size_type colon = items[i].find(':');
+		listener.port = ofToInt(items[i].substr(0, colon));
+		if(colon != string::npos) {
+			listener.subtree = items[i].substr(colon+1);
+		}
+		if(listener.port == 0) {
+			ofLogWarning() << "ignoring bad listener \"" << items[i] << "\"";
+			continue;
+		}
+		listeners.push_back(listener);
+	}
 }
@@ -23,8 +23,10 @@
 #pragma once
 
 #include "OscReceiver.h"
+#include "OscSender.h"
 #include "ScriptEngine.h"
 #include "ResourceManager.h"
+#include "FrameSync.h"
 
 #define PACKAGE	"visual"
 #define	VERSION	"0.3.0"
@@ -69,15 +71,52 @@ class Config {
 		
 		unsigned int listeningPort; //< the listening port
 		
+		/// an extra osc listening port, each runs on its own thread
+		struct Listener {
+			unsigned int port;
+			string subtree; //< only accept messages within this address, "" for all
+		};
+		vector<Listener> listeners; //< extra listening ports
+		unsigned int tcpListeningPort; //< SLIP framed tcp listening port, 0 for none
+		string shmName; //< shared memory ring name for same host senders, "" for none
+		unsigned int shmSize; //< shared memory ring size in bytes
+		
+		unsigned int oscQueueSize; //< max osc messages queued between frames
+		bool oscCoalesce; //< only apply the newest osc message per address each frame?
+		unsigned int oscReceiveBufferSize; //< socket receive buffer bytes, 0 for default (linux only)
+		
+		string oscRecordFile; //< record received osc to this log file, "" for none
+		string oscReplayFile; //< replay this osc log file, "" for none
+		bool oscReplayFast; //< replay as fast as possible instead of in real time?
+		bool oscLatencyStats; //< stamp received osc for latency stats?
+		bool oscTrafficStats; //< count received osc & handler time per address prefix?
+		unsigned int oscStatsInterval; //< seconds between osc stats notifications, 0 for none
+		
+		unsigned int oscBacklogSize; //< max addresses held while paused, 0 to discard
+		unsigned int oscBacklogTriggers; //< max triggers held while paused
+		bool oscBacklogDropNewest; //< drop new messages when the backlog is full instead of the oldest?
+		
+		bool oscMirror; //< send changed object properties each frame?
+		unsigned int oscMirrorRate; //< max mirrored sends per second per address, 0 for no limit
+		
 		string sendingIp; //< ip to send to
 		unsigned int sendingPort; //< port to send to
 		
+		unsigned int oscSendInterval; //< min ms between sent bundles, 0 for each frame
+		bool oscSendImmediate; //< send each osc message as it's sent, no bundling?
+		unsigned int oscMaxBundleSize; //< max sent bundle size in bytes
+		
 		string baseAddress; //< base osc listening/sending address
 		string notificationAddress; //< base osc sending address for notifications
 		string deviceAddress; //< base osc sending addess for devices
 	
 		unsigned int connectionId; //< our connection id when sending notifications
 		
+		string syncMode; //< frame sync mode: "leader", "follower", or "" for none
+		string syncGroup; //< frame sync multicast group
+		unsigned int syncPort; //< frame sync multicast port
+		unsigned int syncMaxSkew; //< max frame sync skew in ms
+		
 		string fontFilename; //< font filename
 		string functionsFilename; //< lua function overrides
 		string helpFilename; //< lua help
@@ -88,16 +127,18 @@ class Config {
 		
 		bool setupAllScenes; //< setup all scenes on load?
 		bool showSceneNames; //< show the scene names?
+		unsigned int setupBudget; //< max ms of scene changes & script loads per frame, 0 for no limit
 
 		/// \section Objects
 		
 		ofPtr<ofApp> app; //< global app pointer
 		
-		ofxOscSender oscSender; //< global osc sender
+		OscSender oscSender; //< global osc sender
 		OscReceiver oscReceiver; //< global osc receiver
 		
 		ScriptEngine scriptEngine; //< global lua scripting engine
 		ResourceManager resourceManager; //< global resources
+		FrameSync frameSync; //< global multi-instance frame sync
 		
 		// \section Bindings
 		
@@ -109,6 +150,9 @@ class Config {
 		void setBaseAddress(string base);
 	
 	private:
+	
+		/// parse "port[:subtree],..." into the listeners
+		void parseListeners(const string &list);
 		
 		// hide all the constructors, copy functions here
 		Config(); // cannot create
@@ -0,0 +1,412 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "FrameSync.h"
+
+#include "Config.h"
+#include "SceneManager.h"
+#include "CommandQueue.h"
+#include "OscMessage.h"
+#include "objects/Sprite.h"
+#include "objects/Video.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+// sync message addresses, the same for all instances
+#define SYNC_FRAME_ADDRESS  "/" PACKAGE "/sync/frame"
+#define SYNC_SPRITE_ADDRESS "/" PACKAGE "/sync/sprite"
+#define SYNC_VIDEO_ADDRESS  "/" PACKAGE "/sync/video"
+
+// how often the leader sends the sprite frames & video positions
+#define SYNC_OBJECTS_MS 250
+
+// max messages per bundle, keeps packets under the typical mtu
+#define SYNC_BUNDLE_MESSAGES 16
+
+// max follower clock slew per frame
+#define SYNC_SLEW_MS 1
+
+// default max skew
+#define SYNC_MAX_SKEW_MS 40
+
+// how often the follower thread wakes to check if it should stop
+#define POLL_TIMEOUT_MS 100
+
+// follower: drop the leader after this long without a frame, about 30 missed
+// frames at 30 fps, so another leader can take over
+#define SYNC_LEADER_TIMEOUT_MS 1000
+
+//--------------------------------------------------------------
+// does the message start with the given arg types, ie. "ihsi"
+static bool hasArgs(const OscMessage &message, const char *types) {
+	for(unsigned int i = 0; types[i] != '\0'; ++i) {
+		if(message.getArgType(i) != (ofxOscArgType) types[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+FrameSync::FrameSync() : mode(OFF), socket(-1), port(0),
+	offset(0), maxSkew(SYNC_MAX_SKEW_MS), skew(0), leaderId(-1),
+	leaderTimestamp(0), objectsTimestamp(0), queuedObject(-1) {}
+
+//--------------------------------------------------------------
+FrameSync::~FrameSync() {
+	stop();
+}
+
+//--------------------------------------------------------------
+bool FrameSync::setup(Mode mode, const string &group, unsigned int port) {
+	stop();
+	if(mode == OFF) {
+		return true;
+	}
+	
+	struct in_addr groupAddress;
+	if(inet_aton(group.c_str(), &groupAddress) == 0 || !IN_MULTICAST(ntohl(groupAddress.s_addr))) {
+		ofLogError() << "FrameSync: \"" << group << "\" is not a multicast address";
+		return false;
+	}
+	
+	if(mode == LEADER) {
+		// the multicast defaults stay on this host or subnet & loop back so
+		// followers on the same host work, the interface is left to the
+		// multicast route so testing without a network needs one on loopback
+		sender.setup(group, port);
+	}
+	else {
+		socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+		if(socket < 0) {
+			ofLogError() << "FrameSync: couldn't create socket: " << strerror(errno);
+			return false;
+		}
+		
+		// several followers may share the port on one host
+		int on = 1;
+		setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	#ifdef SO_REUSEPORT
+		setsockopt(socket, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+	#endif
+		struct sockaddr_in address;
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port = htons(port);
+		struct ip_mreq membership;
+		membership.imr_multiaddr = groupAddress;
+		membership.imr_interface.s_addr = htonl(INADDR_ANY);
+		if(bind(socket, (struct sockaddr *) &address, sizeof(address)) < 0 ||
+		   setsockopt(socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+			ofLogError() << "FrameSync: couldn't join " << group << ":" << port
+				<< ": " << strerror(errno);
+			close(socket);
+			socket = -1;
+			return false;
+		}
+	}
+	
+	this->mode = mode;
+	this->port = port;
+	leaderId = -1;
+	pending = State();
+	current = State();
+	queuedScene = "";
+	queuedObject = -1;
+	if(mode == FOLLOWER) {
+		startThread(true);
+	}
+	ofLogVerbose(PACKAGE) << "FrameSync: " << (mode == LEADER ? "leading" : "following")
+		<< " on " << group << ":" << port;
+	return true;
+}
+
+//--------------------------------------------------------------
+void FrameSync::stop() {
+	if(mode == OFF) {
+		return;
+	}
+	if(isThreadRunning()) {
+		waitForThread(true);
+	}
+	if(mode == LEADER) {
+		sender.stop();
+	}
+	if(socket >= 0) {
+		close(socket);
+		socket = -1;
+	}
+	mode = OFF;
+}
+
+//--------------------------------------------------------------
+void FrameSync::update(SceneManager &sceneManager, CommandQueue &commands) {
+	switch(mode) {
+		case LEADER:
+			sendState(sceneManager);
+			break;
+		case FOLLOWER:
+			applyState(sceneManager, commands);
+			break;
+		case OFF:
+			break;
+	}
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void FrameSync::threadedFunction() {
+	buffer.resize(OSC_MAX_PACKET_SIZE);
+	struct pollfd fd;
+	fd.fd = socket;
+	fd.events = POLLIN;
+	while(isThreadRunning()) {
+		fd.revents = 0;
+		int ready = poll(&fd, 1, POLL_TIMEOUT_MS);
+		ssize_t count = 0;
+		if(ready > 0) {
+			count = recv(socket, &buffer[0], buffer.size(), 0);
+		}
+		uint64_t received = ofGetElapsedTimeMillis();
+		lock();
+		if(count > 0) {
+			parsePacket(&buffer[0], count, received);
+		}
+		if(leaderId >= 0 && received - leaderTimestamp > SYNC_LEADER_TIMEOUT_MS) {
+			ofLogNotice() << "FrameSync: lost leader " << leaderId;
+			leaderId = -1;
+		}
+		unlock();
+	}
+}
+
+//--------------------------------------------------------------
+void FrameSync::parsePacket(const char *data, unsigned int size, uint64_t received) {
+	osc::IpEndpointName endpoint;
+	try {
+		osc::ReceivedPacket packet(data, (int) size);
+		if(!packet.IsBundle()) {
+			return; // the leader always sends bundles
+		}
+		osc::ReceivedBundle bundle(packet);
+		osc::ReceivedBundle::const_iterator element;
+		for(element = bundle.ElementsBegin(); element != bundle.ElementsEnd(); ++element) {
+			if(element->IsBundle()) {
+				continue;
+			}
+			osc::ReceivedMessage m(*element);
+			string address = m.AddressPattern();
+			OscMessage message(m, address, endpoint);
+			
+			// id, clock, scene, & slideshow object
+			if(address == SYNC_FRAME_ADDRESS && hasArgs(message, "ihsi")) {
+				
+				// lock onto the first leader
+				int id = message.getArgAsInt32(0);
+				if(leaderId < 0) {
+					leaderId = id;
+					ofLogNotice() << "FrameSync: following leader " << leaderId;
+				}
+				else if(id != leaderId) {
+					continue;
+				}
+				leaderTimestamp = received;
+				pending.bFrame = true;
+				pending.clock = message.getArgAsInt64(1);
+				pending.received = received;
+				pending.scene = message.getArgAsString(2);
+				pending.object = message.getArgAsInt32(3);
+			}
+			
+			// id, address, frame, frame timestamp, & direction
+			else if(address == SYNC_SPRITE_ADDRESS && hasArgs(message, "isihi")) {
+				if(message.getArgAsInt32(0) != leaderId) {
+					continue;
+				}
+				ObjectState object;
+				object.address = message.getArgAsString(1);
+				object.frame = message.getArgAsInt32(2);
+				object.timestamp = message.getArgAsInt64(3);
+				object.bForward = message.getArgAsInt32(4);
+				object.progress = -1;
+				object.received = received;
+				pending.objects.push_back(object);
+			}
+			
+			// id, address, & position
+			else if(address == SYNC_VIDEO_ADDRESS && hasArgs(message, "isf")) {
+				if(message.getArgAsInt32(0) != leaderId) {
+					continue;
+				}
+				ObjectState object;
+				object.address = message.getArgAsString(1);
+				object.frame = 0;
+				object.timestamp = 0;
+				object.bForward = true;
+				object.progress = message.getArgAsFloat(2);
+				object.received = received;
+				pending.objects.push_back(object);
+			}
+		}
+	}
+	catch(osc::Exception &e) {
+		ofLogWarning() << "FrameSync: malformed packet: " << e.what();
+	}
+	
+	// main thread stalled, keep the newest
+	if(pending.objects.size() > 1024) {
+		pending.objects.erase(pending.objects.begin(), pending.objects.end()-1024);
+	}
+}
+
+//--------------------------------------------------------------
+void FrameSync::sendState(SceneManager &sceneManager) {
+	Config &config = Config::instance();
+	Scene *scene = sceneManager.getCurrentScene();
+	ofxOscBundle bundle;
+	
+	ofxOscMessage message;
+	message.setAddress(SYNC_FRAME_ADDRESS);
+	message.addIntArg(config.connectionId);
+	message.addInt64Arg(getTime());
+	message.addStringArg(scene != NULL ? scene->getName() : "");
+	message.addIntArg(scene != NULL ? scene->getCurrentObject() : -1);
+	bundle.addMessage(message);
+	
+	// sprite frames & video positions a few times a second
+	uint64_t now = ofGetElapsedTimeMillis();
+	if(scene != NULL && now - objectsTimestamp >= SYNC_OBJECTS_MS) {
+		objectsTimestamp = now;
+		for(unsigned int i = 0; i < scene->getNumObjects(); ++i) {
+			DrawableObject *object = scene->getObject(i);
+			Sprite *sprite = dynamic_cast<Sprite*>(object);
+			Video *video = dynamic_cast<Video*>(object);
+			if(sprite != NULL && sprite->getAnimate()) {
+				message.clear();
+				message.setAddress(SYNC_SPRITE_ADDRESS);
+				message.addIntArg(config.connectionId);
+				message.addStringArg(sprite->getOscRootAddress());
+				message.addIntArg(sprite->getCurrentFrame());
+				message.addInt64Arg(sprite->getFrameTimestamp());
+				message.addIntArg(sprite->getForward());
+			}
+			else if(video != NULL && video->getPlay() && video->isLoaded()) {
+				message.clear();
+				message.setAddress(SYNC_VIDEO_ADDRESS);
+				message.addIntArg(config.connectionId);
+				message.addStringArg(video->getOscRootAddress());
+				message.addFloatArg(video->getProgress());
+			}
+			else {
+				continue;
+			}
+			bundle.addMessage(message);
+			if(bundle.getMessageCount() >= SYNC_BUNDLE_MESSAGES) {
+				sendBundle(bundle);
+			}
+		}
+	}
+	if(bundle.getMessageCount() > 0) {
+		sendBundle(bundle);
+	}
+}
+
+//--------------------------------------------------------------
+void FrameSync::applyState(SceneManager &sceneManager, CommandQueue &commands) {
+	lock();
+	std::swap(pending, current);
+	pending.bFrame = false;
+	pending.objects.clear();
+	unlock();
+	
+	if(current.bFrame) {
+		
+		// clock: the leader sends right before updating, so its clock on
+		// receipt is close enough, slew within the max skew or jump
+		int64_t target = (int64_t) current.clock - (int64_t) current.received;
+		int64_t error = target - offset;
+		skew = (int) -error;
+		if(llabs(error) > maxSkew) {
+			offset = target;
+			ofLogVerbose(PACKAGE) << "FrameSync: clock jumped " << error << " ms";
+		}
+		else {
+			offset += ofClamp(error, -SYNC_SLEW_MS, SYNC_SLEW_MS);
+		}
+		
+		// scene & slideshow object, queue a change once until it's been made
+		// or the leader moves on
+		Scene *scene = sceneManager.getCurrentScene();
+		if(current.scene == "") {
+			// leader has no scene
+		}
+		else if(scene != NULL && scene->getName() == current.scene &&
+		        (current.object < 0 || scene->getCurrentObject() == current.object)) {
+			queuedScene = "";
+		}
+		else if(current.scene != queuedScene || current.object != queuedObject) {
+			commands.push(Command(Command::FOLLOW_SCENE, current.scene, current.object));
+			queuedScene = current.scene;
+			queuedObject = current.object;
+		}
+	}
+	
+	for(unsigned int i = 0; i < current.objects.size(); ++i) {
+		const ObjectState &state = current.objects[i];
+		DrawableObject *object = sceneManager.findObject(state.address + "/");
+		if(object == NULL || object->getOscRootAddress() != state.address) {
+			continue; // not loaded here or a different object
+		}
+		if(state.progress < 0) {
+			Sprite *sprite = dynamic_cast<Sprite*>(object);
+			if(sprite != NULL) {
+				sprite->syncFrame(state.frame, state.timestamp, state.bForward, maxSkew);
+			}
+		}
+		else {
+			Video *video = dynamic_cast<Video*>(object);
+			if(video == NULL || !video->isLoaded() || video->getVideo().getDuration() <= 0) {
+				continue;
+			}
+			
+			// where the leader is now, assuming it's still playing
+			float duration = video->getVideo().getDuration();
+			float progress = state.progress + (ofGetElapsedTimeMillis() - state.received) *
+				video->getSpeed() / (duration * 1000.0);
+			if(fabs(video->getProgress() - progress) * duration * 1000 > maxSkew) {
+				video->setProgress(progress);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void FrameSync::sendBundle(ofxOscBundle &bundle) {
+	sender.sendBundle(bundle); // always sent as a bundle
+	bundle.clear();
+}
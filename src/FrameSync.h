@@ -0,0 +1,151 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "OscSender.h"
+
+class SceneManager;
+class CommandQueue;
+
+/// frame synchronized playback across instances over multicast osc
+///
+/// the leader sends its animation clock, current scene & slideshow object each
+/// frame, plus the sprite frames & video positions in the current scene a few
+/// times a second, each follower locks its clock, scene, sprites & videos to
+/// the leader within a max skew
+///
+/// the leader sends from an OscSender thread so the main thread never waits on
+/// the socket & followers queue scene changes as commands so they are setup
+/// within the per frame budget, landing the frame after they're received
+///
+/// the follower clock slews by at most a ms per frame to keep animation smooth,
+/// & jumps if the skew is over the max, ie. on start
+///
+/// instances are distinguished by their connection id, followers lock onto the
+/// first leader they hear & ignore any others until it's been silent for a
+/// second
+///
+/// the leader sends on the interface the multicast route picks, so testing on
+/// one host without a network needs a multicast route on loopback
+class FrameSync : protected ofThread {
+
+	public:
+	
+		enum Mode {
+			OFF,
+			LEADER,  //< send the clock & scene state
+			FOLLOWER //< lock to the leader's
+		};
+	
+		FrameSync();
+		virtual ~FrameSync();
+		
+		/// start on a multicast group & port, ie. "239.255.86.1" 9980,
+		/// returns false if the socket can't be setup
+		bool setup(Mode mode, const string &group, unsigned int port);
+		
+		/// stop & close the socket, the clock keeps its current offset
+		void stop();
+		
+		Mode getMode() {return mode;}
+		
+		/// leader: send the clock & scene state, follower: apply the latest
+		/// received from the leader & queue any scene change, call once per
+		/// frame on the main thread before updating the scenes
+		void update(SceneManager &sceneManager, CommandQueue &commands);
+		
+		/// the animation clock in ms, the leader's clock when following,
+		/// otherwise the local elapsed time
+		uint64_t getTime() {return (uint64_t)((int64_t) ofGetElapsedTimeMillis() + offset);}
+		
+		/// max skew in ms for the clock, sprites, & videos before jumping
+		void setMaxSkew(unsigned int ms) {maxSkew = ms;}
+		unsigned int getMaxSkew() {return maxSkew;}
+		
+		/// follower: last measured clock skew to the leader in ms,
+		/// positive when ahead
+		int getSkew() {return skew;}
+		
+		/// follower: the leader's connection id, -1 if none heard yet or lost
+		int getLeaderId() {return leaderId;}
+	
+	protected:
+	
+		/// follower: receive & parse leader packets
+		void threadedFunction();
+		
+		/// follower: parse a leader packet into the pending state, called with
+		/// the thread locked, messages with an unknown address or the wrong
+		/// arg types are ignored
+		void parsePacket(const char *data, unsigned int size, uint64_t received);
+		
+		/// leader: send the clock & scene state
+		void sendState(SceneManager &sceneManager);
+		
+		/// follower: apply the pending state
+		void applyState(SceneManager &sceneManager, CommandQueue &commands);
+		
+		/// leader: send a bundle, then clear it
+		void sendBundle(ofxOscBundle &bundle);
+	
+		/// a sprite frame or video position in the leader's current scene
+		struct ObjectState {
+			string address; //< object root address
+			unsigned int frame; //< sprite frame
+			uint64_t timestamp; //< sprite frame start on the leader clock
+			bool bForward; //< sprite direction
+			float progress; //< video position 0-1, < 0 for sprites
+			uint64_t received; //< local time received
+		};
+	
+		/// leader state, written by the thread & taken by the main thread
+		struct State {
+			State() : bFrame(false), clock(0), received(0), object(-1) {}
+			bool bFrame; //< new frame clock?
+			uint64_t clock; //< leader clock
+			uint64_t received; //< local time the clock was received
+			string scene;
+			int object;
+			vector<ObjectState> objects;
+		};
+	
+		Mode mode;
+		int socket; //< follower socket, -1 when closed
+		OscSender sender; //< leader
+		unsigned int port;
+		int64_t offset; //< clock offset from the local elapsed time
+		unsigned int maxSkew;
+		int skew;
+		int leaderId;
+		uint64_t leaderTimestamp; //< follower: local time of the last leader frame
+		
+		State pending; //< thread -> main thread, locked
+		State current; //< main thread
+		
+		uint64_t objectsTimestamp; //< leader: last time the objects were sent
+		string queuedScene; //< follower: last scene change queued, "" once there
+		int queuedObject; //< follower: last slideshow object queued
+		vector<char> buffer; //< follower: received
+};
@@ -23,12 +23,13 @@
 #include "Scene.h"
 
 #include "objects/DrawableObject.h"
+#include "OscSender.h"
 
 //--------------------------------------------------------------
 Scene::Scene(string name) : bSetup(false), name(name), background(0), fps(-1),
 	bSlideshow(false), currentObject(-1) {
 	// set address here as the baseAddress might have been changed in lua
-	oscRootAddress = Config::instance().baseAddress+"/"+name;
+	setOscRootAddress(Config::instance().baseAddress+"/"+name);
 }
 
 //--------------------------------------------------------------
@@ -43,7 +44,7 @@ void Scene::addObject(DrawableObject* object) {
 		return;
 	}
 
-	object->setOscRootAddress(oscRootAddress+"/"+object->getName());
+	object->setOscRootAddress(this, object->getName());
 	addOscObject(object);
 	objects.push_back(object);
 	
@@ -153,6 +154,40 @@ void Scene::exit() {
 	}
 }
 
+//--------------------------------------------------------------
+void Scene::sendState(OscSender &sender) {
+	for(unsigned int i = 0; i < objects.size(); ++i) {
+		const PropertyCache &cache = objects[i]->updatePropertyCache();
+		for(unsigned int p = 0; p < cache.size(); ++p) {
+			const vector<char> &encoded = cache.getEncoded(p);
+			sender.sendEncoded(&encoded[0], encoded.size());
+		}
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int Scene::mirrorState(OscSender &sender, uint64_t minInterval) {
+	uint64_t now = ofGetElapsedTimeMillis();
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < objects.size(); ++i) {
+		PropertyCache &cache = objects[i]->updatePropertyCache();
+		for(unsigned int p = 0; p < cache.size(); ++p) {
+			// rate capped properties stay dirty & go out once the cap allows,
+			// so the last value is always sent
+			if(!cache.isDirty(p) ||
+			   (minInterval > 0 && cache.getSentTime(p) > 0 &&
+			    now - cache.getSentTime(p) < minInterval)) {
+				continue;
+			}
+			const vector<char> &encoded = cache.getEncoded(p);
+			sender.sendEncoded(&encoded[0], encoded.size());
+			cache.setSent(p, now);
+			count++;
+		}
+	}
+	return count;
+}
+
 //--------------------------------------------------------------
 void Scene::nextObject() {
 	if(objects.empty()) {
@@ -25,6 +25,8 @@
 #include "OscObject.h"
 #include "objects/DrawableObject.h"
 
+class OscSender;
+
 class Scene : public OscObject {
 
 	public:
@@ -40,6 +42,10 @@ class Scene : public OscObject {
 		
 		/// clears (deletes) all the objects in the list
 		void clearObjects();
+		
+		/// get the objects
+		unsigned int getNumObjects() {return objects.size();}
+		DrawableObject* getObject(unsigned int index) {return objects[index];}
 
 		/// setup resources, set earlySetup = true if objects are being
 		/// setup before the scene is active
@@ -54,6 +60,15 @@ class Scene : public OscObject {
 		/// tell objects to exit, does not delete
 		void exit();
 		
+		/// send the property messages of all objects, unchanged properties
+		/// are sent from each object's cache without re-encoding
+		void sendState(OscSender &sender);
+		
+		/// send the property messages which changed since they were last
+		/// mirrored, each address at most once per minInterval ms,
+		/// returns the number sent
+		unsigned int mirrorState(OscSender &sender, uint64_t minInterval=0);
+		
 		/// slideshow mode
 		void setSlideshow(bool s) {bSlideshow = s;}
 		bool getSlideshow() {return bSlideshow;}
@@ -61,6 +76,7 @@ class Scene : public OscObject {
 		void prevObject();
 		void gotoObject(unsigned int num);
 		void gotoObject(string name);
+		int getCurrentObject() {return currentObject;} //< -1 if none
 		
 		/// Util
 		string getName() {return name;}
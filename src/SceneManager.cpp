@@ -33,7 +33,8 @@
 //--------------------------------------------------------------
 SceneManager::SceneManager() : OscObject(""),
 	currentScene(-1), bShowSceneName(true),
-	bSetBackground(false), bSetupScene(false) {}
+	setupTime(0), maxSetupTime(0),
+	mirroredScene(NULL), mirroredObject(-1) {}
 
 //--------------------------------------------------------------
 SceneManager::~SceneManager() {
@@ -56,7 +57,7 @@ void SceneManager::addScene(Scene* scene) {
 		}
 	}
 	
-	scene->setOscRootAddress(oscRootAddress+"/"+scene->getName());
+	scene->setOscRootAddress(this, scene->getName());
 	scenes.push_back(scene);
 }
 
@@ -70,7 +71,40 @@ void SceneManager::removeScene(Scene* scene) {
 	iter = find(scenes.begin(), scenes.end(), scene);
 	if(iter != scenes.end()) {
 		scenes.erase(iter);
+		scene->getOscRootPath().detach();
+		if(scene == mirroredScene) {
+			mirroredScene = NULL;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+DrawableObject* SceneManager::findObject(const string &address) {
+	
+	// scenes follow our root, so match it once & compare the scene name
+	// segment by symbol id
+	const string &root = getOscRootAddress();
+	if(address.size() <= root.size()+1 || address[root.size()] != '/' ||
+	   address.compare(0, root.size(), root) != 0) {
+		return NULL;
+	}
+	string::size_type start = root.size()+1;
+	string::size_type slash = address.find('/', start);
+	if(slash == string::npos) {
+		return NULL; // no object
+	}
+	int symbol = OscSymbols::find(address.substr(start, slash-start));
+	if(symbol < 0) {
+		return NULL;
 	}
+	for(unsigned int i = 0; i < scenes.size(); ++i) {
+		OscPath &path = scenes[i]->getOscRootPath();
+		if(path.getParent() == &getOscRootPath() && path.getSegments().size() == 1 &&
+		   path.getSegments()[0] == (unsigned int) symbol) {
+			return dynamic_cast<DrawableObject*>(scenes[i]->findOscObject(address));
+		}
+	}
+	return NULL;
 }
 
 //--------------------------------------------------------------
@@ -81,6 +115,16 @@ Scene* SceneManager::getCurrentScene() {
 	return scenes[currentScene];
 }
 
+//--------------------------------------------------------------
+void SceneManager::setCurrentScene(unsigned int num) {
+	if(num >= scenes.size()) {
+		ofLogWarning() << "SceneManager: cannot set current scene num " << num
+			<< ", index out of range";
+		return;
+	}
+	currentScene = num;
+}
+
 //--------------------------------------------------------------
 void SceneManager::clear(bool keepCurScene) {
 
@@ -90,6 +134,7 @@ void SceneManager::clear(bool keepCurScene) {
 		delete o;
 	}
 	scenes.clear();
+	mirroredScene = NULL; // deleted, mirror the next scene's name
 	
 	if(!keepCurScene) {
 		currentScene = -1;
@@ -175,6 +220,29 @@ void SceneManager::gotoScene(string name) {
 	ofLogWarning() << "SceneManager: cannot goto scene \"" << name << "\", name not found";
 }
 
+//--------------------------------------------------------------
+void SceneManager::followScene(string name, int object) {
+	Scene *scene = getCurrentScene();
+	if(scene == NULL || scene->getName() != name) {
+		for(unsigned int i = 0; i < scenes.size(); ++i) {
+			if(name == scenes.at(i)->getName()) {
+				exit();
+				currentScene = i;
+				ofLogVerbose(PACKAGE) << "SceneManager: following scene \"" << name << "\"";
+				setupScene(scenes.at(currentScene));
+				scene = scenes.at(currentScene);
+				break;
+			}
+		}
+		if(scene == NULL || scene->getName() != name) {
+			return; // not found
+		}
+	}
+	if(object >= 0 && object != scene->getCurrentObject()) {
+		scene->gotoObject((unsigned int) object);
+	}
+}
+
 //--------------------------------------------------------------
 void SceneManager::setup(bool loadAll) {
 	
@@ -216,18 +284,6 @@ void SceneManager::draw() {
 	if(currentScene >= 0 && currentScene < (int) scenes.size()) {
 		Scene* s = scenes.at(currentScene);
 		
-		if(bSetupScene) {
-			s->setup();
-			bSetupScene = false;
-		}
-		
-		// only set background in gl state since scene changes may happen
-		// in osc receiver thread
-		if(bSetBackground) {
-			ofBackground(s->getBackground());
-			bSetBackground = false;
-		}
-		
 		// artificial frame rate timing
 		if(s->getFps() > 0) {
 		if(frameRateTimer.alarm()) {
@@ -261,6 +317,46 @@ void SceneManager::exit(bool exitAll) {
 	}
 }
 
+//--------------------------------------------------------------
+void SceneManager::sendState(OscSender &sender, bool sendAll) {
+	ofxOscMessage message;
+	message.setAddress(getOscRootAddress()+"/scene");
+	message.addStringArg(currentScene < 0 ? "" : scenes[currentScene]->getName());
+	sender.sendMessage(message);
+	if(sendAll) {
+		for(unsigned int i = 0; i < scenes.size(); ++i) {
+			scenes[i]->sendState(sender);
+		}
+	}
+	else if(currentScene >= 0) {
+		scenes[currentScene]->sendState(sender);
+	}
+}
+
+//--------------------------------------------------------------
+void SceneManager::mirrorState(OscSender &sender, unsigned int maxRate) {
+	Scene *scene = getCurrentScene();
+	if(scene == NULL) {
+		return;
+	}
+	if(scene != mirroredScene) {
+		ofxOscMessage message;
+		message.setAddress(getOscRootAddress()+"/scene");
+		message.addStringArg(scene->getName());
+		sender.sendMessage(message);
+		mirroredScene = scene;
+		mirroredObject = -1;
+	}
+	if(scene->getCurrentObject() != mirroredObject) {
+		ofxOscMessage message;
+		message.setAddress(getOscRootAddress()+"/scene/object");
+		message.addIntArg(scene->getCurrentObject());
+		sender.sendMessage(message);
+		mirroredObject = scene->getCurrentObject();
+	}
+	scene->mirrorState(sender, (maxRate > 0 ? 1000 / maxRate : 0));
+}
+
 //--------------------------------------------------------------
 void SceneManager::setFrameRate(unsigned int rate) {
 	frameRate = rate;
@@ -272,72 +368,96 @@ void SceneManager::setFrameRate(unsigned int rate) {
 // PROTECTED
 //--------------------------------------------------------------
 void SceneManager::setupScene(Scene* s) {
-	bSetupScene = true;
-	bSetBackground = true;
+	uint64_t start = ofGetElapsedTimeMicros();
+	s->setup();
+	ofBackground(s->getBackground());
+	setupTime = ofGetElapsedTimeMicros() - start;
+	if(setupTime > maxSetupTime) {
+		maxSetupTime = setupTime;
+	}
+	ofLogVerbose(PACKAGE) << "SceneManager: setup scene \"" << s->getName() << "\" in "
+		<< setupTime / 1000.0 << " ms";
 	setFrameRate(s->getFps());
 	sceneNameTimer.setAlarm(SCENE_NAME_MS);
 }
 
 //--------------------------------------------------------------
-bool SceneManager::processOscMessage(const ofxOscMessage& message) {
+const OscCommandTable& SceneManager::getOscCommands() {
+	static OscCommandTable table;
+	if(table.size() == 0) {
+		table.add("/scene/slideshow", OSC_SLIDESHOW);
+		table.add("/scene/object", OSC_OBJECT);
+		table.add("/scene/object/prev", OSC_OBJECT_PREV);
+		table.add("/scene/object/next", OSC_OBJECT_NEXT);
+	}
+	return table;
+}
+
+//--------------------------------------------------------------
+bool SceneManager::processOscMessage(const OscMessage& message) {
 
 	if(currentScene >= 0 && currentScene < (int) scenes.size()) {
 
 		Scene *scene = scenes.at(currentScene);
 
-		if(message.getAddress() == getOscRootAddress() + "/scene/slideshow") {
-			bool b;
-			if(OscObject::tryBool(message, b, 0)) {
-				scene->setSlideshow(b);
-			}
-			return true;
-		}
+		switch(getOscCommands().find(getOscRootAddress(), message.getAddress())) {
 		
-		if(message.getAddress() == getOscRootAddress() + "/scene/object") {
-			if(!objectChangeTimer.alarm()) {
+			case OSC_SLIDESHOW: {
+				bool b;
+				if(OscObject::tryBool(message, b, 0)) {
+					scene->setSlideshow(b);
+				}
 				return true;
 			}
 			
-			string name;
-			int index;
-			if(OscObject::tryString(message, name, 0)) {
-				scene->gotoObject(name);
-				return true;
-			}
-			else if(OscObject::tryNumber(message, index, 0)) {
-				if(index > -1) {
-					scene->gotoObject(index);
+			case OSC_OBJECT: {
+				if(!objectChangeTimer.alarm()) {
+					return true;
 				}
-				return true;
+				
+				string name;
+				int index;
+				if(OscObject::tryString(message, name, 0)) {
+					scene->gotoObject(name);
+					return true;
+				}
+				else if(OscObject::tryNumber(message, index, 0)) {
+					if(index > -1) {
+						scene->gotoObject(index);
+					}
+					return true;
+				}
+				
+				sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
+				break;
 			}
 			
-			sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
-		}
-		
-		else if(message.getAddress() == getOscRootAddress() + "/scene/object/prev") {
-			if(!objectChangeTimer.alarm()) {
-				return true;
-			}
-			// ignore TouchOsc "button off" events
-			if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
-				return true;
-			}
-			scene->prevObject();
-			sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
-			return true;
-		}
-		
-		else if(message.getAddress() == getOscRootAddress() + "/scene/object/next") {
-			if(!objectChangeTimer.alarm()) {
+			case OSC_OBJECT_PREV:
+				if(!objectChangeTimer.alarm()) {
+					return true;
+				}
+				// ignore TouchOsc "button off" events
+				if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+					return true;
+				}
+				scene->prevObject();
+				sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
 				return true;
-			}
-			// ignore TouchOsc "button off" events
-			if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+			
+			case OSC_OBJECT_NEXT:
+				if(!objectChangeTimer.alarm()) {
+					return true;
+				}
+				// ignore TouchOsc "button off" events
+				if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+					return true;
+				}
+				scene->nextObject();
+				sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
 				return true;
-			}
-			scene->nextObject();
-			sceneChangeTimer.setAlarm(OBJECT_CHANGE_MS);
-			return true;
+			
+			default:
+				break;
 		}
 
 		return scene->processOsc(message);
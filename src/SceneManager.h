@@ -24,6 +24,7 @@
 
 #include "Scene.h"
 #include "ofxTimer.h"
+#include "OscCommandTable.h"
 
 class SceneManager : public OscObject {
 
@@ -40,16 +41,29 @@ class SceneManager : public OscObject {
 		
 		/// get the current scene, returns NULL if none
 		Scene* getCurrentScene();
+		
+		/// set the current scene without setting it up, loading resources, or
+		/// changing the background, ie. to dispatch osc without a window
+		void setCurrentScene(unsigned int num);
 
 		/// clears (deletes) all scenes,
 		/// set keepCurScene = true to keep the current scene index if reloading
 		void clear(bool keepCurScene=false);
 
+		/// find the object in any scene with the longest root address matching
+		/// the given address, ie. "/visual/scene1/rect/position/x",
+		/// returns NULL if none
+		DrawableObject* findObject(const string &address);
+
 		// scene transport
 		void nextScene();
 		void prevScene();
 		void gotoScene(unsigned int num);
 		void gotoScene(string name);
+		
+		/// go to a scene & slideshow object right away if not already there,
+		/// ignores the scene change timer, ie. when following another instance
+		void followScene(string name, int object=-1);
 
 		/// setup current scene/scenes, load resources
 		void setup(bool loadAll=false);
@@ -63,20 +77,45 @@ class SceneManager : public OscObject {
 		/// exit current scene/scenes
 		void exit(bool exitAll=false);
 		
+		/// send the current scene name & the current scene/scenes object
+		/// properties as a state dump
+		void sendState(OscSender &sender, bool sendAll=false);
+		
+		/// send the current scene name & slideshow object when they change and
+		/// the current scene object properties changed since they were last
+		/// mirrored, each property address at most maxRate times a second,
+		/// 0 for no limit
+		void mirrorState(OscSender &sender, unsigned int maxRate=0);
+		
 		/// show the scene name when changing?
 		void showSceneName(bool show) {bShowSceneName = show;}
 		void toggleSceneName() {bShowSceneName = !bShowSceneName;}
 		
 		/// set the psuedo frameRate calculated via timer
 		void setFrameRate(unsigned int rate);
+		
+		/// last & max time spent setting up a scene on change in us,
+		/// ie. loading resources
+		uint64_t getSetupTime() {return setupTime;}
+		uint64_t getMaxSetupTime() {return maxSetupTime;}
 
 	protected:
 
-		/// set the background and fps from a scene
+		/// setup a scene & set the background and fps from it, call on the
+		/// main thread
 		void setupScene(Scene* s);
 
 		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
+		bool processOscMessage(const OscMessage& message);
+		
+		/// osc commands by address relative to the root address
+		enum OscCommand {
+			OSC_SLIDESHOW,
+			OSC_OBJECT,
+			OSC_OBJECT_PREV,
+			OSC_OBJECT_NEXT
+		};
+		static const OscCommandTable& getOscCommands();
 
 	private:
 
@@ -92,6 +131,9 @@ class SceneManager : public OscObject {
 		ofxTimer frameRateTimer;
 		unsigned int frameRate;
 		
-		bool bSetBackground; //< does the background need to be set?
-		bool bSetupScene; //< does the current scene need to be setup?
+		uint64_t setupTime; //< last scene setup time in us
+		uint64_t maxSetupTime; //< max scene setup time in us
+		
+		Scene *mirroredScene; //< last mirrored scene
+		int mirroredObject; //< last mirrored slideshow object
 };
@@ -23,7 +23,10 @@
 #include "ScriptEngine.h"
 
 #include "Config.h"
+#include "ofApp.h"
 #include "ofxOsc.h"
+#include "OscMessage.h"
+#include "OscPattern.h"
 
 // declare the wrapped modules
 extern "C" {
@@ -31,20 +34,89 @@ extern "C" {
 	int luaopen_visual(lua_State* L);
 }
 
+// push a received message arg as a lua value, unsupported types are nil
+static void pushOscArg(lua_State *L, const OscMessage& msg, unsigned int index) {
+	switch(msg.getArgType(index)) {
+		case OFXOSC_TYPE_INT32:
+			lua_pushinteger(L, msg.getArgAsInt32(index));
+			break;
+		case OFXOSC_TYPE_INT64:
+			lua_pushnumber(L, msg.getArgAsInt64(index));
+			break;
+		case OFXOSC_TYPE_FLOAT:
+			lua_pushnumber(L, msg.getArgAsFloat(index));
+			break;
+		case OFXOSC_TYPE_DOUBLE:
+			lua_pushnumber(L, msg.getArgAsDouble(index));
+			break;
+		case OFXOSC_TYPE_STRING: case OFXOSC_TYPE_SYMBOL:
+			lua_pushstring(L, msg.getArgAsString(index));
+			break;
+		case OFXOSC_TYPE_TRUE:
+			lua_pushboolean(L, true);
+			break;
+		case OFXOSC_TYPE_FALSE:
+			lua_pushboolean(L, false);
+			break;
+		case OFXOSC_TYPE_BLOB: {
+			unsigned int size;
+			const char *data = msg.getArgAsBlob(index, size);
+			lua_pushlstring(L, data, size);
+			break;
+		}
+		default:
+			lua_pushnil(L);
+			break;
+	}
+}
+
 //--------------------------------------------------------------
-ScriptEngine::ScriptEngine() {
+ScriptEngine::ScriptEngine() : bOscDispatching(false) {
 	currentScript = "";
+	resetOscBatch();
 	lua.addListener(this);
 }
 
 //--------------------------------------------------------------
 bool ScriptEngine::setup() {
+	// refs belong to the old state
+	resetOscBatch();
+	oscBindings.clear();
+	oscPatternBindings.clear();
+	oscUnrefs.clear();
 	if(!lua.init(true)) {
 		ofLogError() << "ScriptEngine: could not init lua";
 		return false;
 	}
 	luaopen_osc(lua); // osc bindings
 	luaopen_visual(lua); // visual bindings
+	
+	// native osc handler routing: osc.bind & osc.unbind
+	lua_getglobal(lua, "osc");
+	if(!lua_istable(lua, -1)) {
+		lua_pop(lua, 1);
+		lua_newtable(lua);
+		lua_pushvalue(lua, -1);
+		lua_setglobal(lua, "osc");
+	}
+	lua_pushlightuserdata(lua, this);
+	lua_pushcclosure(lua, luaOscBind, 1);
+	lua_setfield(lua, -2, "bind");
+	lua_pushlightuserdata(lua, this);
+	lua_pushcclosure(lua, luaOscUnbind, 1);
+	lua_setfield(lua, -2, "unbind");
+	lua_pop(lua, 1);
+	
+	// object properties by address
+	lua_getglobal(lua, "visual");
+	if(lua_istable(lua, -1)) {
+		lua_pushcfunction(lua, luaGetProperty);
+		lua_setfield(lua, -2, "getProperty");
+		lua_pushcfunction(lua, luaSetProperty);
+		lua_setfield(lua, -2, "setProperty");
+	}
+	lua_pop(lua, 1);
+	
 	lua.doScript(Config::instance().functionsFilename); // custom functions
 	lua.doScript(Config::instance().helpFilename); // help functions
 	return true;
@@ -150,8 +222,352 @@ void ScriptEngine::sendOsc(const ofxOscMessage& msg) {
 	}
 }
 
+//--------------------------------------------------------------
+ScriptEngine::OscDelivery ScriptEngine::sendOsc(const OscMessage& msg) {
+	if(!lua.isValid()) {
+		return OSC_NOT_DELIVERED;
+	}
+	if(callOscBindings(msg)) {
+		return OSC_BOUND;
+	}
+	if(lua.isFunction("oscReceivedBatch")) {
+		batchOsc(msg);
+		return OSC_CALLBACK;
+	}
+	if(!lua.isFunction("oscReceived")) {
+		return OSC_NOT_DELIVERED;
+	}
+	ofxOscMessage *message = new ofxOscMessage;
+	msg.copyTo(*message);
+	lua_getglobal(lua, "oscReceived");
+	lua.pushobject("ofxOscMessage", message);
+	if(lua_pcall(lua, 1, 0, 0) != 0) {
+		string line = "Error running oscReceived(): " + (string) lua_tostring(lua, -1);
+		lua.errorOccurred(line);
+	}
+	return OSC_CALLBACK;
+}
+
+//--------------------------------------------------------------
+void ScriptEngine::flushOsc() {
+	if(oscBatchFilled == 0 || !lua.isValid()) {
+		return;
+	}
+	lua_State *L = lua;
+	
+	// clear entries left from a larger batch
+	lua_rawgeti(L, LUA_REGISTRYINDEX, oscBatchRef);
+	for(unsigned int i = oscBatchSize+1; i <= oscBatchFilled; ++i) {
+		lua_pushnil(L);
+		lua_rawseti(L, -2, i);
+	}
+	oscBatchFilled = oscBatchSize;
+	if(oscBatchSize == 0 || !lua.isFunction("oscReceivedBatch")) {
+		lua_pop(L, 1);
+		oscBatchSize = 0;
+		return;
+	}
+	oscBatchSize = 0;
+	
+	lua_getglobal(L, "oscReceivedBatch");
+	lua_insert(L, -2); // function, batch
+	if(lua_pcall(L, 1, 0, 0) != 0) {
+		string line = "Error running oscReceivedBatch(): " + (string) lua_tostring(L, -1);
+		lua.errorOccurred(line);
+	}
+}
+
 // PRIVATE
 //--------------------------------------------------------------
 void ScriptEngine::errorReceived(string& msg) {
 	ofLogError(PACKAGE) << msg;
 }
+
+//--------------------------------------------------------------
+void ScriptEngine::batchOsc(const OscMessage& msg) {
+	lua_State *L = lua;
+	if(oscBatchRef == LUA_NOREF) {
+		lua_newtable(L);
+		oscBatchRef = luaL_ref(L, LUA_REGISTRYINDEX);
+		lua_newtable(L);
+		oscPoolRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+	unsigned int index = oscBatchSize+1;
+	
+	// reuse a message table from the pool or create a new one
+	lua_rawgeti(L, LUA_REGISTRYINDEX, oscPoolRef);
+	lua_rawgeti(L, -1, index);
+	unsigned int prevNumArgs = 0;
+	if(lua_istable(L, -1)) {
+		lua_getfield(L, -1, "n");
+		prevNumArgs = lua_tointeger(L, -1);
+		lua_pop(L, 1);
+	}
+	else {
+		lua_pop(L, 1);
+		lua_createtable(L, msg.getNumArgs(), 3);
+		lua_pushvalue(L, -1);
+		lua_rawseti(L, -3, index);
+	}
+	
+	// fill
+	lua_pushlstring(L, msg.getAddress().c_str(), msg.getAddress().size());
+	lua_setfield(L, -2, "address");
+	char types[OSC_MESSAGE_MAX_ARGS];
+	for(unsigned int i = 0; i < msg.getNumArgs(); ++i) {
+		types[i] = (char) msg.getArgType(i);
+		pushOscArg(L, msg, i);
+		lua_rawseti(L, -2, i+1);
+	}
+	for(unsigned int i = msg.getNumArgs()+1; i <= prevNumArgs; ++i) {
+		lua_pushnil(L);
+		lua_rawseti(L, -2, i);
+	}
+	lua_pushlstring(L, types, msg.getNumArgs());
+	lua_setfield(L, -2, "types");
+	lua_pushinteger(L, msg.getNumArgs());
+	lua_setfield(L, -2, "n");
+	
+	// batch[index] = message
+	lua_rawgeti(L, LUA_REGISTRYINDEX, oscBatchRef);
+	lua_pushvalue(L, -2);
+	lua_rawseti(L, -2, index);
+	lua_pop(L, 3); // batch, message, pool
+	
+	oscBatchSize++;
+	if(oscBatchSize > oscBatchFilled) {
+		oscBatchFilled = oscBatchSize;
+	}
+}
+
+//--------------------------------------------------------------
+bool ScriptEngine::callOscBindings(const OscMessage& msg) {
+	if(oscBindings.empty() && oscPatternBindings.empty()) {
+		return false;
+	}
+	const string &address = msg.getAddress();
+	
+	// collect first as handlers may bind or unbind
+	oscCalls.clear();
+	if(OscPattern::isPattern(address)) {
+		// incoming pattern: match against the bound addresses
+		ofPtr<OscPattern> pattern = OscPattern::get(address);
+		for(unordered_map<string, int>::iterator iter = oscBindings.begin();
+			iter != oscBindings.end(); ++iter) {
+			if(pattern->matches(iter->first)) {
+				oscCalls.push_back(std::make_pair(iter->second, false));
+			}
+		}
+	}
+	else {
+		unordered_map<string, int>::iterator iter = oscBindings.find(address);
+		if(iter != oscBindings.end()) {
+			oscCalls.push_back(std::make_pair(iter->second, false));
+		}
+		for(unsigned int i = 0; i < oscPatternBindings.size(); ++i) {
+			if(oscPatternBindings[i].pattern->matches(address)) {
+				oscCalls.push_back(std::make_pair(oscPatternBindings[i].ref, true));
+			}
+		}
+	}
+	if(oscCalls.empty()) {
+		return false;
+	}
+	
+	// a handler may unbind a later one & bind another, which could reuse its
+	// registry slot, so hold the unrefs until all have been called
+	bOscDispatching = true;
+	for(unsigned int i = 0; i < oscCalls.size(); ++i) {
+		callOscBinding(oscCalls[i].first, msg, oscCalls[i].second);
+	}
+	bOscDispatching = false;
+	for(unsigned int i = 0; i < oscUnrefs.size(); ++i) {
+		luaL_unref(lua, LUA_REGISTRYINDEX, oscUnrefs[i]);
+	}
+	oscUnrefs.clear();
+	return true;
+}
+
+//--------------------------------------------------------------
+void ScriptEngine::callOscBinding(int ref, const OscMessage& msg, bool bAddress) {
+	lua_State *L = lua;
+	if(!lua_checkstack(L, msg.getNumArgs()+2)) {
+		return;
+	}
+	if(std::find(oscUnrefs.begin(), oscUnrefs.end(), ref) != oscUnrefs.end()) {
+		return; // unbound by an earlier handler
+	}
+	lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+	if(bAddress) {
+		lua_pushlstring(L, msg.getAddress().c_str(), msg.getAddress().size());
+	}
+	for(unsigned int i = 0; i < msg.getNumArgs(); ++i) {
+		pushOscArg(L, msg, i);
+	}
+	if(lua_pcall(L, msg.getNumArgs() + (bAddress ? 1 : 0), 0, 0) != 0) {
+		string line = "Error running osc handler for " + msg.getAddress()
+			+ ": " + (string) lua_tostring(L, -1);
+		lua.errorOccurred(line);
+	}
+}
+
+//--------------------------------------------------------------
+void ScriptEngine::unrefOscBinding(int ref) {
+	if(bOscDispatching) {
+		oscUnrefs.push_back(ref);
+	}
+	else {
+		luaL_unref(lua, LUA_REGISTRYINDEX, ref);
+	}
+}
+
+//--------------------------------------------------------------
+int ScriptEngine::luaOscBind(lua_State *L) {
+	ScriptEngine *engine = (ScriptEngine *) lua_touserdata(L, lua_upvalueindex(1));
+	string address = luaL_checkstring(L, 1);
+	luaL_checktype(L, 2, LUA_TFUNCTION);
+	if(address.empty() || address[0] != '/') {
+		return luaL_error(L, "osc.bind: address must start with '/'");
+	}
+	lua_pushvalue(L, 2);
+	int ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	
+	// replace any existing handler
+	if(OscPattern::isPattern(address)) {
+		for(unsigned int i = 0; i < engine->oscPatternBindings.size(); ++i) {
+			OscPatternBinding &b = engine->oscPatternBindings[i];
+			if(b.pattern->getPattern() == address) {
+				engine->unrefOscBinding(b.ref);
+				b.ref = ref;
+				return 0;
+			}
+		}
+		OscPatternBinding b;
+		b.pattern = ofPtr<OscPattern>(new OscPattern(address));
+		b.ref = ref;
+		engine->oscPatternBindings.push_back(b);
+	}
+	else {
+		unordered_map<string, int>::iterator iter = engine->oscBindings.find(address);
+		if(iter != engine->oscBindings.end()) {
+			engine->unrefOscBinding(iter->second);
+			iter->second = ref;
+		}
+		else {
+			engine->oscBindings[address] = ref;
+		}
+	}
+	return 0;
+}
+
+//--------------------------------------------------------------
+int ScriptEngine::luaOscUnbind(lua_State *L) {
+	ScriptEngine *engine = (ScriptEngine *) lua_touserdata(L, lua_upvalueindex(1));
+	
+	// no address: unbind all
+	if(lua_gettop(L) == 0 || lua_type(L, 1) == LUA_TNIL) {
+		for(unordered_map<string, int>::iterator iter = engine->oscBindings.begin();
+			iter != engine->oscBindings.end(); ++iter) {
+			engine->unrefOscBinding(iter->second);
+		}
+		for(unsigned int i = 0; i < engine->oscPatternBindings.size(); ++i) {
+			engine->unrefOscBinding(engine->oscPatternBindings[i].ref);
+		}
+		engine->oscBindings.clear();
+		engine->oscPatternBindings.clear();
+		return 0;
+	}
+	
+	string address = luaL_checkstring(L, 1);
+	unordered_map<string, int>::iterator iter = engine->oscBindings.find(address);
+	if(iter != engine->oscBindings.end()) {
+		engine->unrefOscBinding(iter->second);
+		engine->oscBindings.erase(iter);
+		return 0;
+	}
+	for(unsigned int i = 0; i < engine->oscPatternBindings.size(); ++i) {
+		if(engine->oscPatternBindings[i].pattern->getPattern() == address) {
+			engine->unrefOscBinding(engine->oscPatternBindings[i].ref);
+			engine->oscPatternBindings.erase(engine->oscPatternBindings.begin()+i);
+			break;
+		}
+	}
+	return 0;
+}
+
+//--------------------------------------------------------------
+// find the object & the address relative to its root
+static DrawableObject* findPropertyObject(const string &address, const char *&relative) {
+	DrawableObject *object = Config::instance().app->sceneManager.findObject(address);
+	if(object == NULL) {
+		return NULL;
+	}
+	relative = address.c_str() + object->getOscRootAddress().size();
+	return object;
+}
+
+//--------------------------------------------------------------
+int ScriptEngine::luaGetProperty(lua_State *L) {
+	string address = luaL_checkstring(L, 1);
+	const char *relative;
+	DrawableObject *object = findPropertyObject(address, relative);
+	PropertyValue values[PROPERTY_MAX_FIELDS];
+	unsigned int n = (object != NULL ? object->getProperty(relative, values) : 0);
+	if(n == 0) {
+		return luaL_error(L, "visual.getProperty: unknown property %s", address.c_str());
+	}
+	for(unsigned int i = 0; i < n; ++i) {
+		switch(values[i].type) {
+			case PropertyValue::BOOL:
+				lua_pushboolean(L, values[i].number != 0);
+				break;
+			case PropertyValue::STRING:
+				lua_pushstring(L, values[i].text.c_str());
+				break;
+			default:
+				lua_pushnumber(L, values[i].number);
+				break;
+		}
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+int ScriptEngine::luaSetProperty(lua_State *L) {
+	string address = luaL_checkstring(L, 1);
+	const char *relative;
+	DrawableObject *object = findPropertyObject(address, relative);
+	PropertyValue values[PROPERTY_MAX_FIELDS];
+	unsigned int n = lua_gettop(L) - 1;
+	if(n > PROPERTY_MAX_FIELDS) {
+		n = PROPERTY_MAX_FIELDS;
+	}
+	for(unsigned int i = 0; i < n; ++i) {
+		int index = i + 2;
+		switch(lua_type(L, index)) {
+			case LUA_TBOOLEAN:
+				values[i].from((bool) lua_toboolean(L, index));
+				break;
+			case LUA_TNUMBER:
+				values[i].from(lua_tonumber(L, index));
+				break;
+			case LUA_TSTRING:
+				values[i].from((string) lua_tostring(L, index));
+				break;
+			default: // skipped
+				break;
+		}
+	}
+	if(object == NULL || !object->setProperty(relative, values, n)) {
+		return luaL_error(L, "visual.setProperty: unknown property %s", address.c_str());
+	}
+	return 0;
+}
+
+//--------------------------------------------------------------
+void ScriptEngine::resetOscBatch() {
+	oscBatchRef = LUA_NOREF;
+	oscPoolRef = LUA_NOREF;
+	oscBatchSize = 0;
+	oscBatchFilled = 0;
+}
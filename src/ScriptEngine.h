@@ -23,13 +23,23 @@
 #pragma once
 
 #include "ofxLua.h"
+#include <unordered_map>
 
 class ofxOscMessage;
+class OscMessage;
+class OscPattern;
 
 class ScriptEngine : private ofxLuaListener {
 
 	public:
 	
+		/// how sendOsc() delivered a message
+		enum OscDelivery {
+			OSC_NOT_DELIVERED, //< no lua handler or callback
+			OSC_BOUND,         //< consumed by an osc.bind handler
+			OSC_CALLBACK       //< passed to oscReceived or oscReceivedBatch
+		};
+	
 		ScriptEngine();
 	
 		bool setup();
@@ -50,8 +60,27 @@ class ScriptEngine : private ofxLuaListener {
 		
 		/// send an osc message to the lua script
 		/// calls the oscReceived lua function
+		///
+		/// if the script defines an oscReceivedBatch function instead, received
+		/// OscMessages are collected as plain lua tables & delivered together
+		/// by flushOsc(), each as {address="/foo", types="if", n=2, 1, 2.5}
+		///
+		/// handlers bound with osc.bind(address, fn) in lua are called instead
+		/// with the message args, ie. fn(1, 2.5), & a handler bound to a
+		/// pattern also gets the address first, ie. fn("/foo/bar", 1, 2.5),
+		/// messages with a handler are not sent to oscReceived
 		void sendOsc(const ofxOscMessage& msg);
 		
+		/// copies to an ofxOscMessage, returns how the message was delivered
+		OscDelivery sendOsc(const OscMessage& msg);
+		
+		/// call oscReceivedBatch with the messages collected since the last
+		/// flush, call once per frame
+		///
+		/// note: the batch & message tables are reused, copy anything which
+		/// should be kept past the call
+		void flushOsc();
+		
 		ofxLua lua;
 		
 		void setCurrentScript(string script) {currentScript = script;}
@@ -61,6 +90,51 @@ class ScriptEngine : private ofxLuaListener {
 	
 		/// lua error callback
 		void errorReceived(string& msg);
+		
+		/// add a message to the batch table
+		void batchOsc(const OscMessage& msg);
+		
+		/// forget the batch tables, call when the lua state is recreated
+		void resetOscBatch();
+		
+		/// call any handlers bound to the message address,
+		/// returns true if there were any
+		bool callOscBindings(const OscMessage& msg);
+		
+		/// call a bound handler with the message args,
+		/// pushes the address first if bAddress is true
+		void callOscBinding(int ref, const OscMessage& msg, bool bAddress);
+		
+		/// release a handler registry ref, deferred until the bound handlers
+		/// have been called if dispatching so the ref can't be reused meanwhile
+		void unrefOscBinding(int ref);
+		
+		/// osc.bind(address, fn) & osc.unbind([address]) lua functions,
+		/// the engine is upvalue 1
+		static int luaOscBind(lua_State *L);
+		static int luaOscUnbind(lua_State *L);
+		
+		/// visual.getProperty(address) & visual.setProperty(address, ...) lua
+		/// functions, get/set an object property by osc address, ie.
+		/// x, y = visual.getProperty("/visual/scene1/rect/position")
+		static int luaGetProperty(lua_State *L);
+		static int luaSetProperty(lua_State *L);
 
 		string currentScript; //< absolute path to current script
+		
+		int oscBatchRef; //< registry ref to the batch table
+		int oscPoolRef; //< registry ref to the reused message tables
+		unsigned int oscBatchSize; //< messages in the current batch
+		unsigned int oscBatchFilled; //< non-nil entries in the batch table
+		
+		/// a lua handler bound to an address pattern
+		struct OscPatternBinding {
+			ofPtr<OscPattern> pattern;
+			int ref; //< registry ref to the handler
+		};
+		unordered_map<string, int> oscBindings; //< address -> handler registry ref
+		vector<OscPatternBinding> oscPatternBindings;
+		vector<pair<int, bool> > oscCalls; //< matched handler refs & whether to pass the address
+		bool bOscDispatching; //< calling bound handlers?
+		vector<int> oscUnrefs; //< refs unbound while dispatching, released after
 };
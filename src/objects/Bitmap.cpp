@@ -22,6 +22,8 @@
 ==============================================================================*/
 #include "Bitmap.h"
 
+#include <climits>
+
 //--------------------------------------------------------------
 Bitmap::Bitmap(string name, unsigned int w, unsigned int h) :
 	DrawableFrame(name), bitmapWidth(w), bitmapHeight(h),
@@ -186,6 +188,54 @@ string Bitmap::getBitmap() {
 	return bitmapString;
 }
 
+//--------------------------------------------------------------
+bool Bitmap::setBitmapData(const char *data, unsigned int size) {
+	return setBitmapData(data, size, bitmapWidth, bitmapHeight);
+}
+
+//--------------------------------------------------------------
+bool Bitmap::setBitmapData(const char *data, unsigned int size,
+                           unsigned int w, unsigned int h) {
+	if(w == 0 || h == 0) {
+		ofLogWarning() << "Bitmap: Cannot set data, bitmap size not set";
+		return false;
+	}
+	if(h > UINT_MAX / w) {
+		ofLogWarning() << "Bitmap: Cannot set data, bitmap size too large: "
+			<< w << "x" << h;
+		return false;
+	}
+	unsigned int numPix = w*h;
+	unsigned int numBytes = numPix/8 + (numPix%8 != 0);
+	if(size < numBytes) {
+		ofLogWarning() << "Bitmap: Not enough bytes in data: " << size
+			<< ", need " << numBytes;
+		return false;
+	}
+	bitmapWidth = w;
+	bitmapHeight = h;
+	bitmap.resize(numPix);
+	for(unsigned int i = 0; i < numPix; ++i) {
+		bitmap[i] = (data[i/8] >> (7 - i%8)) & 1;
+	}
+	computePixelSize();
+	return true;
+}
+
+//--------------------------------------------------------------
+void Bitmap::setBitmapSize(unsigned int w, unsigned int h) {
+	if(w == 0 || h == 0) {
+		ofLogWarning() << "Bitmap: Cannot set bitmap size " << w << "x" << h;
+		return;
+	}
+	if(w == bitmapWidth && h == bitmapHeight) {
+		return;
+	}
+	bitmapWidth = w;
+	bitmapHeight = h;
+	clear();
+}
+
 //--------------------------------------------------------------
 void Bitmap::setWidth(unsigned int w) {
 	width = w;
@@ -205,6 +255,23 @@ void Bitmap::setSize(unsigned int w, unsigned int h) {
 	computePixelSize();
 }
 
+//--------------------------------------------------------------
+const PropertyTable& Bitmap::getPropertyTable() {
+	static const Property properties[] = {
+		{"position", 0, NULL, {
+			PROPERTY_MEMBER(Bitmap, "x", pos.x),
+			PROPERTY_MEMBER(Bitmap, "y", pos.y)
+		}},
+		{"size", 0, PROPERTY_HOOK(Bitmap, computePixelSize), {
+			PROPERTY_MEMBER(Bitmap, "width", width),
+			PROPERTY_MEMBER(Bitmap, "height", height)
+		}},
+		{"center", 0, NULL, {PROPERTY_MEMBER(Bitmap, "", bDrawFromCenter)}}
+	};
+	static const PropertyTable table(properties, 3, &DrawableObject::getPropertyTable());
+	return table;
+}
+
 // PROTECTED
 //--------------------------------------------------------------
 void Bitmap::computePixelSize() {
@@ -213,7 +280,7 @@ void Bitmap::computePixelSize() {
 }
 
 //--------------------------------------------------------------
-bool Bitmap::processOscMessage(const ofxOscMessage& message) {
+bool Bitmap::processOscMessage(const OscMessage& message) {
 
 	// call the base class
 	if(DrawableObject::processOscMessage(message)) {
@@ -221,41 +288,17 @@ bool Bitmap::processOscMessage(const ofxOscMessage& message) {
 	}
 
 
-	if(message.getAddress() == oscRootAddress + "/position") {
-		tryNumber(message, pos.x, 0);
-		tryNumber(message, pos.y, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/x") {
-		tryNumber(message, pos.x, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/y") {
-		tryNumber(message, pos.y, 0);
-		return true;
-	}
-	
-
-	else if(message.getAddress() == oscRootAddress + "/size") {
-		tryNumber(message, width, 0);
-		tryNumber(message, height, 1);
-		computePixelSize();
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/width") {
-		tryNumber(message, width, 0);
-		computePixelSize();
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/height") {
-		tryNumber(message, height, 0);
-		computePixelSize();
-		return true;
-	}
-
-
-	else if(message.getAddress() == oscRootAddress + "/center") {
-		tryBool(message, bDrawFromCenter, 0);
+	// packed bits blob, optionally preceded by a new bitmap width & height
+	if(isOscAddress(message, "/data")) {
+		const char *data;
+		unsigned int size, w, h;
+		if(tryBlob(message, data, size, 0)) {
+			setBitmapData(data, size);
+		}
+		else if(tryNumber(message, w, 0) && tryNumber(message, h, 1) &&
+		        tryBlob(message, data, size, 2)) {
+			setBitmapData(data, size, w, h);
+		}
 		return true;
 	}
 
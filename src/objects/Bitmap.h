@@ -41,6 +41,24 @@ class Bitmap : public DrawableFrame {
 		// getters / setters
 		void setBitmap(string bitmapString); // computes from string
 		string getBitmap();
+		
+		/// set from packed bits, 1 = filled, row by row with the first pixel in
+		/// the high bit of the first byte, rows are not padded,
+		/// returns false if the bitmap size isn't set or there aren't enough
+		/// bytes for it
+		bool setBitmapData(const char *data, unsigned int size);
+		
+		/// set the bitmap dimensions & packed bits together, the dimensions
+		/// are only changed if the data is accepted, returns false if either
+		/// dimension is 0 or there aren't enough bytes
+		bool setBitmapData(const char *data, unsigned int size,
+		                   unsigned int w, unsigned int h);
+		
+		/// set the bitmap dimensions, clears the bitmap if changed,
+		/// ignored if either dimension is 0
+		void setBitmapSize(unsigned int w, unsigned int h);
+		unsigned int getBitmapWidth() {return bitmapWidth;}
+		unsigned int getBitmapHeight() {return bitmapHeight;}
 
 		ofPoint& getPos() {return pos;}
 		void setPos(ofPoint &p) {pos = p;}
@@ -55,6 +73,9 @@ class Bitmap : public DrawableFrame {
 		void setDrawFromCenter(bool c) {bDrawFromCenter = c;}
 		
 		string getType() {return "bitmap";}
+		
+		static const PropertyTable& getPropertyTable();
+		const PropertyTable& getProperties() {return getPropertyTable();}
 
 	protected:
 	
@@ -62,7 +83,7 @@ class Bitmap : public DrawableFrame {
 		void computePixelSize();
 
 		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
+		bool processOscMessage(const OscMessage& message);
 
 		vector<bool> bitmap; //< actual bitmap
 		unsigned int bitmapWidth, bitmapHeight;	//< dimen of the bitmap
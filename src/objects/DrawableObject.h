@@ -23,6 +23,7 @@
 #pragma once
 
 #include "OscObject.h"
+#include "Property.h"
 #include "../Config.h"
 
 class DrawableObject : public OscObject {
@@ -65,42 +66,117 @@ class DrawableObject : public OscObject {
 		/// should this object be cleared when it's parent scene is exiting?
 		virtual bool shouldClearOnExit() {return false;}
 
+		/// \section Properties
+		
+		/// the property table for this class, derived classes with properties
+		/// define their own including their base class table & override
+		/// getProperties() to return it
+		static const PropertyTable& getPropertyTable() {
+			static const Property properties[] = {
+				{"color", 3, NULL, {
+					PROPERTY_MEMBER(DrawableObject, "R", color.r),
+					PROPERTY_MEMBER(DrawableObject, "G", color.g),
+					PROPERTY_MEMBER(DrawableObject, "B", color.b),
+					PROPERTY_MEMBER(DrawableObject, "A", color.a)
+				}},
+				{"visible", 0, NULL, {PROPERTY_MEMBER(DrawableObject, "", bVisible)}}
+			};
+			static const PropertyTable table(properties, 2);
+			return table;
+		}
+		virtual const PropertyTable& getProperties() {return getPropertyTable();}
+		
+		/// set a property or one of its fields by address relative to the
+		/// object root, ie. "/position" or "/position/x", returns false if
+		/// there is no such property
+		bool setProperty(const char *address, const PropertyValue *values,
+		                 unsigned int numValues) {
+			const PropertyTable::Entry *entry = getProperties().find(address);
+			if(entry == NULL) {
+				return false;
+			}
+			entry->property->set(this, entry->field, values, numValues);
+			return true;
+		}
+		
+		/// get a property or one of its fields by address relative to the
+		/// object root, values must hold PROPERTY_MAX_FIELDS,
+		/// returns the number of values or 0 if there is no such property
+		unsigned int getProperty(const char *address, PropertyValue *values) {
+			const PropertyTable::Entry *entry = getProperties().find(address);
+			if(entry == NULL) {
+				return 0;
+			}
+			return entry->property->get(this, entry->field, values);
+		}
+		
+		/// add a message with the current values for each property, or only
+		/// the given property name, ie. "/visual/scene1/rect/position 10 20"
+		void getPropertyMessages(vector<ofxOscMessage> &messages, const string &name="") {
+			const PropertyTable &table = getProperties();
+			PropertyValue values[PROPERTY_MAX_FIELDS];
+			for(unsigned int i = 0; i < table.size(); ++i) {
+				const Property &property = table.at(i);
+				if(name != "" && name != property.name) {
+					continue;
+				}
+				messages.push_back(ofxOscMessage());
+				ofxOscMessage &message = messages.back();
+				message.setAddress(getOscRootAddress() + "/" + property.name);
+				unsigned int n = property.get(this, -1, values);
+				for(unsigned int v = 0; v < n; ++v) {
+					values[v].write(message);
+				}
+			}
+		}
+
+		/// update the cached, encoded property messages, only properties whose
+		/// values changed since the last update are re-encoded
+		PropertyCache& updatePropertyCache() {
+			propertyCache.update(this, getProperties(), oscRootPath);
+			return propertyCache;
+		}
+
 	protected:
 
 		/// process one osc message, derived objects should call this and call
 		/// DrawableObject::processOscMessage() to handle the base variables
-		virtual bool processOscMessage(const ofxOscMessage& message) {
-									   
-			if(message.getAddress() == oscRootAddress + "/color") {
-				if(message.getNumArgs() > 2) {
-					tryNumber(message, (unsigned int&) color.r, 0);
-					tryNumber(message, (unsigned int&) color.g, 1);
-					tryNumber(message, (unsigned int&) color.b, 2);
-					if(message.getNumArgs() > 3) {
-						tryNumber(message, (unsigned int&) color.a, 3);
-					}
-				}
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/color/R") {
-				tryNumber(message, (unsigned int&) color.r, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/color/G") {
-				tryNumber(message, (unsigned int&) color.g, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/color/B") {
-				tryNumber(message, (unsigned int&) color.b, 0);
-				return true;
+		///
+		/// sets properties from the property table & replies to
+		/// "<root>/get [name]" with the current property values
+		virtual bool processOscMessage(const OscMessage& message) {
+			const string &address = message.getAddress();
+			const string &root = getOscRootAddress();
+			if(address.size() <= root.size() ||
+			   address.compare(0, root.size(), root) != 0) {
+				return false;
 			}
-			else if(message.getAddress() == oscRootAddress + "/color/A") {
-				tryNumber(message, (unsigned int&) color.a, 0);
+			const char *relative = address.c_str() + root.size();
+			
+			const PropertyTable::Entry *entry = getProperties().find(relative);
+			if(entry != NULL) {
+				const Property &property = *entry->property;
+				unsigned int numValues = (entry->field < 0 ? property.size() : 1);
+				if(message.getNumArgs() < numValues) {
+					numValues = message.getNumArgs();
+				}
+				PropertyValue values[PROPERTY_MAX_FIELDS];
+				for(unsigned int i = 0; i < numValues; ++i) {
+					const PropertyField &field = property.fields[entry->field < 0 ? i : entry->field];
+					values[i].read(message, i, field.type);
+				}
+				property.set(this, entry->field, values, numValues);
 				return true;
 			}
-
-			else if(message.getAddress() == oscRootAddress + "/visible") {
-				tryBool(message, bVisible, 0);
+			
+			else if(strcmp(relative, "/get") == 0) {
+				string name;
+				tryString(message, name, 0);
+				vector<ofxOscMessage> messages;
+				getPropertyMessages(messages, name);
+				for(unsigned int i = 0; i < messages.size(); ++i) {
+					Config::instance().oscSender.sendMessage(messages[i]);
+				}
 				return true;
 			}
 
@@ -110,6 +186,8 @@ class DrawableObject : public OscObject {
 		ofColor color;
 		bool bVisible;
 		string name;
+		
+		PropertyCache propertyCache; //< encoded property messages
 };
 
 // drawable object with an animation frame time
@@ -22,21 +22,24 @@
 ==============================================================================*/
 #include "Image.h"
 
+// max pixels width or height, the largest texture most GPUs support
+#define MAX_PIXELS_SIZE 16384
+
 //--------------------------------------------------------------
 Image::Image(string name) : DrawableFrame(name),
-	pos(0, 0), width(0), height(0), bDrawFromCenter(false) {
+	pos(0, 0), width(0), height(0), bDrawFromCenter(false), bOwnsImage(false) {
 	clear();
 }
 
 //--------------------------------------------------------------
 Image::Image(string name, string filename) : DrawableFrame(name),
-	pos(0, 0), width(0), height(0), bDrawFromCenter(false), filename(filename) {
+	pos(0, 0), width(0), height(0), bDrawFromCenter(false), bOwnsImage(false), filename(filename) {
 	clear();
 }
 
 //--------------------------------------------------------------
 Image::Image(unsigned int frameTime, string filename) : DrawableFrame("", frameTime),
-	pos(0, 0), width(0), height(0), bDrawFromCenter(false), filename(filename) {
+	pos(0, 0), width(0), height(0), bDrawFromCenter(false), bOwnsImage(false), filename(filename) {
 	clear();
 }
 
@@ -58,6 +61,7 @@ bool Image::loadFile(string filename) {
 		this->filename = filename;
 	}
 	image = Config::instance().resourceManager.getImage(baseName);
+	bOwnsImage = false;
 
 	if(loaded) {
 		ofLogVerbose(PACKAGE) << "Image: loaded \"" << baseName << "\" "
@@ -74,6 +78,9 @@ bool Image::loadFile(string filename) {
 //--------------------------------------------------------------
 void Image::setup() {
 	string baseName = ofFilePath::getBaseName(filename);
+	if(bOwnsImage) {
+		return; // keep pixels set via osc
+	}
 	if(Config::instance().resourceManager.imageExists(baseName)) {
 		image = Config::instance().resourceManager.getImage(baseName);
 		if(width == 0)	width = image->getWidth();
@@ -112,9 +119,34 @@ void Image::draw(int x, int y, unsigned int w, unsigned int h) {
 //--------------------------------------------------------------
 void Image::clear() {
 	image = ofPtr<ofImage>(new ofImage); // empty image
+	bOwnsImage = false;
 	color.set(255);
 }
 
+//--------------------------------------------------------------
+bool Image::setPixels(const char *data, unsigned int size, unsigned int w, unsigned int h) {
+	if(w == 0 || h == 0 || w > MAX_PIXELS_SIZE || h > MAX_PIXELS_SIZE) {
+		ofLogWarning() << "Image: \"" << name << "\" bad pixels size: "
+			<< w << "x" << h;
+		return false;
+	}
+	if(w > size/4/h) { // w*h*4 > size without overflow
+		ofLogWarning() << "Image: \"" << name << "\" not enough bytes in pixels: "
+			<< size << ", need " << (uint64_t) w*h*4;
+		return false;
+	}
+	if(!bOwnsImage) {
+		image = ofPtr<ofImage>(new ofImage);
+		bOwnsImage = true;
+	}
+	
+	// only reallocates when the size changes
+	image->setFromPixels((const unsigned char *) data, w, h, OF_IMAGE_COLOR_ALPHA);
+	if(width == 0)	width = w;
+	if(height == 0) height = h;
+	return true;
+}
+
 //--------------------------------------------------------------
 void Image::setSize(unsigned int w, unsigned int h) {
 	width = w;
@@ -122,7 +154,24 @@ void Image::setSize(unsigned int w, unsigned int h) {
 }
 
 //--------------------------------------------------------------
-bool Image::processOscMessage(const ofxOscMessage& message) {
+const PropertyTable& Image::getPropertyTable() {
+	static const Property properties[] = {
+		{"position", 0, NULL, {
+			PROPERTY_MEMBER(Image, "x", pos.x),
+			PROPERTY_MEMBER(Image, "y", pos.y)
+		}},
+		{"size", 0, NULL, {
+			PROPERTY_MEMBER(Image, "width", width),
+			PROPERTY_MEMBER(Image, "height", height)
+		}},
+		{"center", 0, NULL, {PROPERTY_MEMBER(Image, "", bDrawFromCenter)}}
+	};
+	static const PropertyTable table(properties, 3, &DrawableObject::getPropertyTable());
+	return table;
+}
+
+//--------------------------------------------------------------
+bool Image::processOscMessage(const OscMessage& message) {
 
 	// call the base class
 	if(DrawableObject::processOscMessage(message)) {
@@ -130,38 +179,14 @@ bool Image::processOscMessage(const ofxOscMessage& message) {
 	}
 
 
-	if(message.getAddress() == oscRootAddress + "/position") {
-		tryNumber(message, pos.x, 0);
-		tryNumber(message, pos.y, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/x") {
-		tryNumber(message, pos.x, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/y") {
-		tryNumber(message, pos.y, 0);
-		return true;
-	}
-	
-	
-	else if(message.getAddress() == oscRootAddress + "/size") {
-		tryNumber(message, width, 0);
-		tryNumber(message, height, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/width") {
-		tryNumber(message, width, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/height") {
-		tryNumber(message, height, 0);
-		return true;
-	}
-
-
-	else if(message.getAddress() == oscRootAddress + "/center") {
-		tryBool(message, bDrawFromCenter, 0);
+	// width, height, & RGBA blob
+	if(isOscAddress(message, "/pixels")) {
+		const char *data;
+		unsigned int size, w, h;
+		if(tryNumber(message, w, 0) && tryNumber(message, h, 1) &&
+		   tryBlob(message, data, size, 2)) {
+			setPixels(data, size, w, h);
+		}
 		return true;
 	}
 
@@ -42,6 +42,12 @@ class Image : public DrawableFrame {
 		
 		void clear();
 		
+		/// set from 8 bit RGBA pixels, row by row, the image is no longer
+		/// shared with others loaded from the same file,
+		/// returns false if there aren't enough bytes for w x h or either is
+		/// 0 or over 16384
+		bool setPixels(const char *data, unsigned int size, unsigned int w, unsigned int h);
+		
 		// getters / setters
 		ofImage& getImage() {return *image;}
 		bool isLoaded() {return image->isAllocated();}
@@ -61,13 +67,17 @@ class Image : public DrawableFrame {
 		void setDrawFromCenter(bool c) {bDrawFromCenter = c;}
 		
 		string getType() {return "image";}
+		
+		static const PropertyTable& getPropertyTable();
+		const PropertyTable& getProperties() {return getPropertyTable();}
 
 	protected:
 
 		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
+		bool processOscMessage(const OscMessage& message);
 		
 		ofPtr<ofImage> image;
+		bool bOwnsImage; //< set from pixels, not shared via the resource manager
 
 		string filename;
 		ofPoint pos;
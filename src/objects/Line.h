@@ -52,50 +52,24 @@ class Line : public DrawableObject {
 		void setPos2(ofPoint &p) {pos2 = p;}
 		
 		string getType() {return "line";}
-
-	protected:
-
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message) {
 		
-			// call the base class
-			if(DrawableObject::processOscMessage(message)) {
-				return true;
-			}
-
-
-			if(message.getAddress() == oscRootAddress + "/position1") {
-				tryNumber(message, pos1.x, 0);
-				tryNumber(message, pos1.y, 1);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position1/x") {
-				tryNumber(message, pos1.x, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position1/y") {
-				tryNumber(message, pos1.y, 0);
-				return true;
-			}
-
-
-			else if(message.getAddress() == oscRootAddress + "/position2") {
-				tryNumber(message, pos2.x, 0);
-				tryNumber(message, pos2.y, 1);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position2/x") {
-				tryNumber(message, pos2.x, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position2/y") {
-				tryNumber(message, pos2.y, 0);
-				return true;
-			}
-
-
-			return false;
+		static const PropertyTable& getPropertyTable() {
+			static const Property properties[] = {
+				{"position1", 0, NULL, {
+					PROPERTY_MEMBER(Line, "x", pos1.x),
+					PROPERTY_MEMBER(Line, "y", pos1.y)
+				}},
+				{"position2", 0, NULL, {
+					PROPERTY_MEMBER(Line, "x", pos2.x),
+					PROPERTY_MEMBER(Line, "y", pos2.y)
+				}}
+			};
+			static const PropertyTable table(properties, 2, &DrawableObject::getPropertyTable());
+			return table;
 		}
+		const PropertyTable& getProperties() {return getPropertyTable();}
+
+	protected:
 
 		ofPoint pos1, pos2; //< start and end positions
 };
@@ -47,35 +47,20 @@ class Pixel : public DrawableObject {
 		void setPos(ofPoint &p) {pos = p;}
 		
 		string getType() {return "pixel";}
-
-	protected:
-
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message) {
 		
-			// call the base class
-			if(DrawableObject::processOscMessage(message)) {
-				return true;
-			}
-
-
-			else if(message.getAddress() == oscRootAddress + "/position") {
-				tryNumber(message, pos.x, 0);
-				tryNumber(message, pos.y, 1);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position/x") {
-				tryNumber(message, pos.x, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position/y") {
-				tryNumber(message, pos.y, 0);
-				return true;
-			}
-
-
-			return false;
+		static const PropertyTable& getPropertyTable() {
+			static const Property properties[] = {
+				{"position", 0, NULL, {
+					PROPERTY_MEMBER(Pixel, "x", pos.x),
+					PROPERTY_MEMBER(Pixel, "y", pos.y)
+				}}
+			};
+			static const PropertyTable table(properties, 1, &DrawableObject::getPropertyTable());
+			return table;
 		}
+		const PropertyTable& getProperties() {return getPropertyTable();}
+
+	protected:
 
 		ofPoint pos;
 };
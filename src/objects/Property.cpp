@@ -0,0 +1,309 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "Property.h"
+
+#include "OscObject.h"
+
+// PropertyValue
+//--------------------------------------------------------------
+bool PropertyValue::read(const OscMessage &message, unsigned int at, Type as) {
+	bool b;
+	double d;
+	type = NONE;
+	switch(as) {
+		case BOOL:
+			if(OscObject::tryBool(message, b, at)) {
+				from(b);
+			}
+			break;
+		case INT: case FLOAT:
+			if(OscObject::tryNumber(message, d, at)) {
+				type = as;
+				number = d;
+			}
+			break;
+		case STRING:
+			if(OscObject::tryString(message, text, at)) {
+				type = STRING;
+			}
+			break;
+		default:
+			break;
+	}
+	return type != NONE;
+}
+
+//--------------------------------------------------------------
+void PropertyValue::write(ofxOscMessage &message) const {
+	switch(type) {
+		case BOOL:
+			message.addBoolArg(number != 0);
+			break;
+		case INT:
+			message.addIntArg((int) number);
+			break;
+		case FLOAT:
+			message.addFloatArg(number);
+			break;
+		case STRING:
+			message.addStringArg(text);
+			break;
+		default:
+			break;
+	}
+}
+
+// Property
+//--------------------------------------------------------------
+// strings only set string fields & numbers only number fields
+static bool accepts(const PropertyField &field, const PropertyValue &value) {
+	return value.type != PropertyValue::NONE &&
+		(value.type == PropertyValue::STRING) == (field.type == PropertyValue::STRING);
+}
+
+//--------------------------------------------------------------
+unsigned int Property::size() const {
+	unsigned int n = 0;
+	while(n < PROPERTY_MAX_FIELDS && fields[n].get != NULL) {
+		n++;
+	}
+	return n;
+}
+
+//--------------------------------------------------------------
+void Property::set(DrawableObject *object, int field, const PropertyValue *values,
+                   unsigned int numValues) const {
+	if(field >= 0) {
+		if(numValues == 0 || !accepts(fields[field], values[0])) {
+			return;
+		}
+		fields[field].set(object, values[0]);
+	}
+	else {
+		if(numValues < minArgs) {
+			return;
+		}
+		unsigned int n = size();
+		for(unsigned int i = 0; i < n && i < numValues; ++i) {
+			if(accepts(fields[i], values[i])) {
+				fields[i].set(object, values[i]);
+			}
+		}
+	}
+	if(hook != NULL) {
+		hook(object);
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int Property::get(DrawableObject *object, int field, PropertyValue *values) const {
+	if(field >= 0) {
+		fields[field].get(object, values[0]);
+		return 1;
+	}
+	unsigned int n = size();
+	for(unsigned int i = 0; i < n; ++i) {
+		fields[i].get(object, values[i]);
+	}
+	return n;
+}
+
+// PropertyTable
+//--------------------------------------------------------------
+PropertyTable::PropertyTable(const Property *properties, unsigned int size,
+                             const PropertyTable *base) {
+	for(unsigned int i = 0; i < size; ++i) {
+		add(&properties[i]);
+	}
+	if(base != NULL) {
+		for(unsigned int i = 0; i < base->size(); ++i) {
+			bool replaced = false;
+			for(unsigned int j = 0; j < size; ++j) {
+				if(strcmp(base->at(i).name, properties[j].name) == 0) {
+					replaced = true;
+					break;
+				}
+			}
+			if(!replaced) {
+				add(&base->at(i));
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+const PropertyTable::Entry* PropertyTable::find(const char *address) const {
+	int index = hashIndex.find(oscHashAddress(address), [this, address](int i) {
+		return entries[i].address == address;
+	});
+	return index < 0 ? NULL : &entries[index];
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void PropertyTable::add(const Property *property) {
+	properties.push_back(property);
+	Entry entry;
+	entry.address = (string) "/" + property->name;
+	entry.property = property;
+	entry.field = -1;
+	addEntry(entry);
+	unsigned int n = property->size();
+	if(n == 1 && property->fields[0].name[0] == '\0') {
+		return; // single field
+	}
+	for(unsigned int i = 0; i < n; ++i) {
+		Entry field = entry;
+		field.address += (string) "/" + property->fields[i].name;
+		field.field = i;
+		addEntry(field);
+	}
+}
+
+//--------------------------------------------------------------
+void PropertyTable::addEntry(const Entry &entry) {
+	entries.push_back(entry);
+	hashIndex.add(oscHashAddress(entry.address.c_str()));
+}
+
+// PropertyCache
+//--------------------------------------------------------------
+unsigned int PropertyCache::update(DrawableObject *object, const PropertyTable &table,
+                                   OscPath &rootPath) {
+	// the path stamp changes whenever the object or anything above it is
+	// re-rooted, so no need to compare the address strings
+	if(this->table != &table || rootStamp != rootPath.getStamp()) {
+		clear();
+		this->table = &table;
+		root = rootPath.getAddress();
+		rootStamp = rootPath.getStamp();
+		entries.resize(table.size());
+	}
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		Entry &entry = entries[i];
+		const Property &property = table.at(i);
+		unsigned int n = property.get(object, -1, current);
+		bool changed = entry.encoded.empty() || n != entry.numValues;
+		for(unsigned int v = 0; v < n && !changed; ++v) {
+			changed = (current[v] != entry.values[v]);
+		}
+		entry.bChanged = changed;
+		if(changed) {
+			entry.bDirty = true;
+			for(unsigned int v = 0; v < n; ++v) {
+				entry.values[v] = current[v]; // reuses string capacity
+			}
+			entry.numValues = n;
+			encode(i, property);
+			count++;
+		}
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+void PropertyCache::clear() {
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		entries[i].encoded.clear();
+		entries[i].numValues = 0;
+		entries[i].bChanged = false;
+		entries[i].bDirty = false;
+		entries[i].sentTime = 0;
+	}
+	table = NULL;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+// osc data is big endian & strings are null terminated & padded to 4 bytes
+static inline void writeUInt32(vector<char> &dest, uint32_t u) {
+	dest.push_back((char)(u >> 24));
+	dest.push_back((char)(u >> 16));
+	dest.push_back((char)(u >> 8));
+	dest.push_back((char) u);
+}
+
+static inline void pad(vector<char> &dest) {
+	do {
+		dest.push_back('\0');
+	} while(dest.size() % 4 != 0);
+}
+
+//--------------------------------------------------------------
+void PropertyCache::encode(unsigned int index, const Property &property) {
+	Entry &entry = entries[index];
+	vector<char> &dest = entry.encoded;
+	dest.clear();
+	
+	// address
+	dest.insert(dest.end(), root.begin(), root.end());
+	dest.push_back('/');
+	dest.insert(dest.end(), property.name, property.name+strlen(property.name));
+	pad(dest);
+	
+	// type tags
+	dest.push_back(',');
+	for(unsigned int i = 0; i < entry.numValues; ++i) {
+		switch(entry.values[i].type) {
+			case PropertyValue::BOOL:
+				dest.push_back(entry.values[i].number != 0 ? 'T' : 'F');
+				break;
+			case PropertyValue::INT:
+				dest.push_back('i');
+				break;
+			case PropertyValue::FLOAT:
+				dest.push_back('f');
+				break;
+			case PropertyValue::STRING:
+				dest.push_back('s');
+				break;
+			default:
+				break;
+		}
+	}
+	pad(dest);
+	
+	// args
+	for(unsigned int i = 0; i < entry.numValues; ++i) {
+		const PropertyValue &value = entry.values[i];
+		switch(value.type) {
+			case PropertyValue::INT:
+				writeUInt32(dest, (uint32_t)(long long) value.number);
+				break;
+			case PropertyValue::FLOAT: {
+				float f = value.number;
+				uint32_t u;
+				memcpy(&u, &f, sizeof(float));
+				writeUInt32(dest, u);
+				break;
+			}
+			case PropertyValue::STRING:
+				dest.insert(dest.end(), value.text.begin(), value.text.end());
+				pad(dest);
+				break;
+			default: // no data: T, F
+				break;
+		}
+	}
+}
@@ -0,0 +1,277 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include "OscHash.h"
+#include <type_traits>
+
+class DrawableObject;
+class OscMessage;
+class OscPath;
+class ofxOscMessage;
+
+/// max number of fields in one property, ie. 4 for a color
+#define PROPERTY_MAX_FIELDS 4
+
+/// a property field value, converts to & from the field's storage type
+struct PropertyValue {
+
+	/// value types, also used for the osc argument types
+	enum Type {
+		NONE,   //< not set
+		BOOL,
+		INT,
+		FLOAT,
+		STRING
+	};
+	
+	PropertyValue() : type(NONE), number(0) {}
+	
+	Type type;
+	double number; //< bool, int & float values
+	string text; //< string value
+	
+	/// read an osc argument as a given type,
+	/// returns false & sets the type to NONE if it can't be converted
+	bool read(const OscMessage &message, unsigned int at, Type as);
+	
+	/// add to an osc message as an argument of the current type
+	void write(ofxOscMessage &message) const;
+	
+	/// same type & value?
+	bool operator==(const PropertyValue &v) const {
+		if(type != v.type) {return false;}
+		return type == STRING ? text == v.text : number == v.number;
+	}
+	bool operator!=(const PropertyValue &v) const {return !(*this == v);}
+
+	/// set from a value
+	void from(bool b) {type = BOOL; number = b;}
+	void from(float f) {type = FLOAT; number = f;}
+	void from(double d) {type = FLOAT; number = d;}
+	void from(const string &s) {type = STRING; text = s;}
+	template<class T> void from(T i) {type = INT; number = (double) i;}
+	
+	/// convert to a value, 8 bit values are clamped to 0-255
+	void to(bool &b) const {b = (number != 0);}
+	void to(float &f) const {f = number;}
+	void to(double &d) const {d = number;}
+	void to(string &s) const {s = text;}
+	void to(unsigned char &c) const {c = (unsigned char) ofClamp(number, 0, 255);}
+	template<class T> void to(T &i) const {i = (T) (long long) number;}
+};
+
+/// value type for a given field storage type
+template<class T> struct PropertyType {
+	static const PropertyValue::Type value =
+		std::is_floating_point<T>::value ? PropertyValue::FLOAT : PropertyValue::INT;
+};
+template<> struct PropertyType<bool> {static const PropertyValue::Type value = PropertyValue::BOOL;};
+template<> struct PropertyType<string> {static const PropertyValue::Type value = PropertyValue::STRING;};
+
+/// one field of a property, ie. "x" of "position"
+struct PropertyField {
+	
+	typedef void (*Getter)(DrawableObject *object, PropertyValue &value);
+	typedef void (*Setter)(DrawableObject *object, const PropertyValue &value);
+	
+	const char *name; //< sub address, "" for a single field property
+	PropertyValue::Type type;
+	Getter get;
+	Setter set;
+};
+
+/// a DrawableObject property settable over osc, from lua, & which can be
+/// snapshot as an osc message
+///
+/// fields are set in order from the message arguments, ie. "/position 10 20",
+/// or on their own via their names, ie. "/position/x 10", arguments which
+/// can't be converted to the field type are skipped
+struct Property {
+
+	/// called after setting any of the fields, ie. to recompute sizes
+	typedef void (*Hook)(DrawableObject *object);
+
+	const char *name; //< address relative to the object root, without the "/"
+	unsigned int minArgs; //< min args when setting all fields, 0 for any
+	Hook hook; //< NULL for none
+	PropertyField fields[PROPERTY_MAX_FIELDS];
+	
+	/// number of fields
+	unsigned int size() const;
+	
+	/// set all fields, or one field if field >= 0, from values in order,
+	/// values with type NONE are skipped, calls the hook
+	void set(DrawableObject *object, int field, const PropertyValue *values,
+	         unsigned int numValues) const;
+	
+	/// get all fields, or one field if field >= 0, into values,
+	/// returns the number of values
+	unsigned int get(DrawableObject *object, int field, PropertyValue *values) const;
+};
+
+/// property lookup table for a DrawableObject class, includes the base
+/// class properties
+///
+/// each property is found by its address & each of its fields by
+/// "property/field", so dispatching a message is a single hash lookup
+class PropertyTable {
+
+	public:
+	
+		/// a property or one of its fields
+		struct Entry {
+			string address; //< relative to the object root, ie. "/position/x"
+			const Property *property;
+			int field; //< field index, -1 for all fields
+		};
+	
+		/// build from a property array & the base class table, if any,
+		/// properties with the same name as one in the base replace it
+		PropertyTable(const Property *properties, unsigned int size,
+		              const PropertyTable *base=NULL);
+		
+		/// find a property or field by address relative to the object root,
+		/// ie. "/position/x", returns NULL if not found
+		const Entry* find(const char *address) const;
+		
+		/// all properties, derived class first
+		unsigned int size() const {return properties.size();}
+		const Property& at(unsigned int index) const {return *properties[index];}
+	
+	protected:
+	
+		void add(const Property *property); //< add property & its fields
+		void addEntry(const Entry &entry); //< add & index an entry
+	
+		vector<const Property*> properties;
+		vector<Entry> entries;
+		OscHashIndex hashIndex; //< entry indices by address hash
+};
+
+/// encoded osc messages with the current values of an object's properties,
+/// ie. "/visual/scene1/rect/position 10 20"
+///
+/// on update, the property values are read & compared to the cached values,
+/// only properties whose values changed are re-encoded
+class PropertyCache {
+
+	public:
+	
+		PropertyCache() : table(NULL), rootStamp(0) {}
+	
+		/// read the current property values, re-encoding those which changed
+		/// since the last update or if the table or root address changed,
+		/// returns the number of properties re-encoded
+		unsigned int update(DrawableObject *object, const PropertyTable &table,
+		                    OscPath &rootPath);
+		
+		/// number of cached properties, same as the table size
+		unsigned int size() const {return entries.size();}
+		
+		/// encoded message for a property, by table index
+		const vector<char>& getEncoded(unsigned int index) const {return entries[index].encoded;}
+		
+		/// was a property re-encoded on the last update?
+		bool isChanged(unsigned int index) const {return entries[index].bChanged;}
+		
+		/// has a property changed since it was last marked as sent?
+		bool isDirty(unsigned int index) const {return entries[index].bDirty;}
+		
+		/// mark a property as sent at a given time in ms, clears the dirty flag
+		void setSent(unsigned int index, uint64_t time) {
+			entries[index].bDirty = false;
+			entries[index].sentTime = time;
+		}
+		
+		/// time in ms a property was last marked as sent, 0 if never
+		uint64_t getSentTime(unsigned int index) const {return entries[index].sentTime;}
+		
+		/// forget the cached values, everything is re-encoded on the next update
+		void clear();
+	
+	protected:
+	
+		/// encode a property message from its cached values
+		void encode(unsigned int index, const Property &property);
+	
+		struct Entry {
+			PropertyValue values[PROPERTY_MAX_FIELDS];
+			unsigned int numValues;
+			vector<char> encoded; //< reuses capacity
+			bool bChanged;
+			bool bDirty; //< changed since last sent
+			uint64_t sentTime;
+		};
+		vector<Entry> entries;
+		PropertyValue current[PROPERTY_MAX_FIELDS]; //< reused for reading
+		const PropertyTable *table; //< table the entries are for
+		string root; //< root address the entries are encoded with
+		unsigned long rootStamp; //< root path stamp when the root was copied
+};
+
+/// \section Table Macros
+///
+/// used to declare the property array in a class getPropertyTable(), ie.
+///
+/// const PropertyTable& Rectangle::getPropertyTable() {
+///     static const Property properties[] = {
+///         {"position", 0, NULL, {
+///             PROPERTY_MEMBER(Rectangle, "x", pos.x),
+///             PROPERTY_MEMBER(Rectangle, "y", pos.y)
+///         }},
+///         {"filled", 0, NULL, {PROPERTY_MEMBER(Rectangle, "", bFilled)}}
+///     };
+///     static const PropertyTable table(properties, 2, &DrawableObject::getPropertyTable());
+///     return table;
+/// }
+
+/// field read & written directly from a member
+#define PROPERTY_MEMBER(Class, name, member) \
+	{name, PropertyType<decltype(static_cast<Class*>(0)->member)>::value, \
+	 [](DrawableObject *o, PropertyValue &v) {v.from(static_cast<Class*>(o)->member);}, \
+	 [](DrawableObject *o, const PropertyValue &v) {v.to(static_cast<Class*>(o)->member);}}
+
+/// field read from a member & written with a setter function
+#define PROPERTY_SETTER(Class, name, member, setter) \
+	{name, PropertyType<decltype(static_cast<Class*>(0)->member)>::value, \
+	 [](DrawableObject *o, PropertyValue &v) {v.from(static_cast<Class*>(o)->member);}, \
+	 [](DrawableObject *o, const PropertyValue &v) { \
+		decltype(static_cast<Class*>(0)->member) value; \
+		v.to(value); \
+		static_cast<Class*>(o)->setter(value);}}
+
+/// field read with a getter & written with a setter function, ie. for values
+/// which aren't stored in a member
+#define PROPERTY_ACCESSOR(Class, name, Type, getter, setter) \
+	{name, PropertyType<Type>::value, \
+	 [](DrawableObject *o, PropertyValue &v) {v.from(static_cast<Class*>(o)->getter());}, \
+	 [](DrawableObject *o, const PropertyValue &v) { \
+		Type value; \
+		v.to(value); \
+		static_cast<Class*>(o)->setter(value);}}
+
+/// property hook calling a member function
+#define PROPERTY_HOOK(Class, function) \
+	[](DrawableObject *o) {static_cast<Class*>(o)->function();}
@@ -83,61 +83,26 @@ class Rectangle : public DrawableObject {
 		void setDrawFromCenter(bool c) {bDrawFromCenter = c;}
 		
 		string getType() {return "rectangle";}
-
-	protected:
-
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message) {
 		
-			// call the base class
-			if(DrawableObject::processOscMessage(message)) {
-				return true;
-			}
-
-
-			if(message.getAddress() == oscRootAddress + "/position") {
-				tryNumber(message, pos.x, 0);
-				tryNumber(message, pos.y, 1);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position/x") {
-				tryNumber(message, pos.x, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/position/y") {
-				tryNumber(message, pos.y, 0);
-				return true;
-			}
-
-
-			else if(message.getAddress() == oscRootAddress + "/size") {
-				tryNumber(message, width, 0);
-				tryNumber(message, height, 1);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/size/width") {
-				tryNumber(message, width, 0);
-				return true;
-			}
-			else if(message.getAddress() == oscRootAddress + "/size/height") {
-				tryNumber(message, height, 0);
-				return true;
-			}
-
-
-			else if(message.getAddress() == oscRootAddress + "/filled") {
-				tryBool(message, bFilled, 0);
-				return true;
-			}
-			
-			else if(message.getAddress() == oscRootAddress + "/center") {
-				tryBool(message, bDrawFromCenter, 0);
-				return true;
-			}
-
-
-			return false;
+		static const PropertyTable& getPropertyTable() {
+			static const Property properties[] = {
+				{"position", 0, NULL, {
+					PROPERTY_MEMBER(Rectangle, "x", pos.x),
+					PROPERTY_MEMBER(Rectangle, "y", pos.y)
+				}},
+				{"size", 0, NULL, {
+					PROPERTY_MEMBER(Rectangle, "width", width),
+					PROPERTY_MEMBER(Rectangle, "height", height)
+				}},
+				{"filled", 0, NULL, {PROPERTY_MEMBER(Rectangle, "", bFilled)}},
+				{"center", 0, NULL, {PROPERTY_MEMBER(Rectangle, "", bDrawFromCenter)}}
+			};
+			static const PropertyTable table(properties, 4, &DrawableObject::getPropertyTable());
+			return table;
 		}
+		const PropertyTable& getProperties() {return getPropertyTable();}
+
+	protected:
 
 		ofPoint pos;
 		unsigned int width, height;
@@ -49,7 +49,7 @@ class Script : public DrawableObject {
 	protected:
 
 		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message) {return false;}
+		bool processOscMessage(const OscMessage& message) {return false;}
 
 		string filename;
 		bool bLoaded;
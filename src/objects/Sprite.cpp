@@ -28,7 +28,7 @@ Sprite::Sprite(string name) :
 	bAnimate(true), bLoop(true), bPingPong(true),
 	bDrawFromCenter(false), bDrawAllLayers(false),
 	currentFrame(0), timestamp(0), bForward(true) {
-	timestamp = ofGetElapsedTimeMillis();
+	timestamp = Config::instance().frameSync.getTime();
 }
 
 //--------------------------------------------------------------
@@ -116,7 +116,7 @@ void Sprite::prevFrame() {
 
 //--------------------------------------------------------------
 void Sprite::gotoFrame(unsigned int num) {
-	if(currentFrame >= (int) frames.size()) {
+	if(num >= frames.size()) {
 		ofLogWarning() << "Sprite \"" << name << "\": cannot goto frame num " << num
 			<< ", index out of range" << endl;
 		return;
@@ -124,6 +124,24 @@ void Sprite::gotoFrame(unsigned int num) {
 	currentFrame = num;
 }
 
+//--------------------------------------------------------------
+bool Sprite::syncFrame(unsigned int num, uint64_t timestamp, bool forward, unsigned int maxSkew) {
+	if(num >= frames.size()) {
+		return false;
+	}
+	if(Config::instance().frameSync.getTime() > timestamp + frames.at(num)->getFrameTime()) {
+		return false; // stale, the next sync will catch it
+	}
+	int64_t skew = (int64_t) this->timestamp - (int64_t) timestamp;
+	if((int) num == currentFrame && forward == bForward && llabs(skew) <= maxSkew) {
+		return false;
+	}
+	currentFrame = num;
+	this->timestamp = timestamp;
+	bForward = forward;
+	return true;
+}
+
 //--------------------------------------------------------------
 void Sprite::gotoFrame(string name) {
 	for(unsigned int i = 0; i < frames.size(); ++i) {
@@ -153,15 +171,21 @@ void Sprite::draw() {
 	// animate frames?
 	if(bAnimate) {
 	
-		// go to next frame if time has elapsed
-		if(ofGetElapsedTimeMillis() - timestamp > frames.at(currentFrame)->getFrameTime()) {
+		// go to next frame if time has elapsed, advancing the timestamp by the
+		// frame time so sprites on the same sync clock don't drift apart
+		uint64_t now = Config::instance().frameSync.getTime();
+		unsigned int frameTime = frames.at(currentFrame)->getFrameTime();
+		if(now > timestamp + frameTime) {
 			if(bForward) {
 				nextFrame();
 			}
 			else {
 				prevFrame();
 			}
-			timestamp = ofGetElapsedTimeMillis();
+			timestamp += frameTime;
+			if(now > timestamp + frameTime) {
+				timestamp = now; // fell behind, don't race to catch up
+			}
 		}
 	}
 
@@ -222,6 +246,28 @@ void Sprite::setDrawFromCenter(bool yesno) {
 	}
 }
 
+//--------------------------------------------------------------
+const PropertyTable& Sprite::getPropertyTable() {
+	static const Property properties[] = {
+		{"position", 0, NULL, {
+			PROPERTY_MEMBER(Sprite, "x", pos.x),
+			PROPERTY_MEMBER(Sprite, "y", pos.y)
+		}},
+		{"size", 0, PROPERTY_HOOK(Sprite, resizeIfNecessary), {
+			PROPERTY_MEMBER(Sprite, "width", width),
+			PROPERTY_MEMBER(Sprite, "height", height)
+		}},
+		{"frame", 0, NULL, {PROPERTY_SETTER(Sprite, "", currentFrame, gotoFrame)}},
+		{"animate", 0, NULL, {PROPERTY_MEMBER(Sprite, "", bAnimate)}},
+		{"loop", 0, NULL, {PROPERTY_MEMBER(Sprite, "", bLoop)}},
+		{"pingpong", 0, NULL, {PROPERTY_MEMBER(Sprite, "", bPingPong)}},
+		{"center", 0, NULL, {PROPERTY_SETTER(Sprite, "", bDrawFromCenter, setDrawFromCenter)}},
+		{"overlay", 0, NULL, {PROPERTY_MEMBER(Sprite, "", bDrawAllLayers)}}
+	};
+	static const PropertyTable table(properties, 8, &DrawableObject::getPropertyTable());
+	return table;
+}
+
 // PROTECTED
 //--------------------------------------------------------------
 void Sprite::resizeIfNecessary() {
@@ -232,80 +278,3 @@ void Sprite::resizeIfNecessary() {
 		}
 	}
 }
-
-//--------------------------------------------------------------
-bool Sprite::processOscMessage(const ofxOscMessage& message) {
-	
-	// call the base class
-	if(DrawableObject::processOscMessage(message)) {
-		return true;
-	}
-
-
-	if(message.getAddress() == oscRootAddress + "/position") {
-		tryNumber(message, pos.x, 0);
-		tryNumber(message, pos.y, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/x") {
-		tryNumber(message, pos.x, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/y") {
-		tryNumber(message, pos.y, 0);
-		return true;
-	}
-	
-	
-	else if(message.getAddress() == oscRootAddress + "/size") {
-		tryNumber(message, width, 0);
-		tryNumber(message, height, 1);
-		resizeIfNecessary();
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/width") {
-		tryNumber(message, width, 0);
-		resizeIfNecessary();
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/height") {
-		tryNumber(message, height, 0);
-		resizeIfNecessary();
-		return true;
-	}
-
-	else if(message.getAddress() == oscRootAddress + "/frame") {
-		unsigned int frame = 0;
-		tryNumber(message, frame, 0);
-		gotoFrame(frame);
-		return true;
-	}
-
-
-	else if(message.getAddress() == oscRootAddress + "/animate") {
-		tryBool(message, bAnimate, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/loop") {
-		tryBool(message, bLoop, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/pingpong") {
-		tryBool(message, bPingPong, 0);
-		return true;
-	}
-	
-	else if(message.getAddress() == oscRootAddress + "/center") {
-		bool b = bDrawFromCenter;
-		if(tryBool(message, b, 0)) {
-			setDrawFromCenter(b);
-		}
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/overlay") {
-		tryBool(message, bDrawAllLayers, 0);
-		return true;
-	}
-
-	return false;
-}
@@ -42,6 +42,14 @@ class Sprite : public DrawableObject {
 		void gotoFrame(unsigned int num);
 		void gotoFrame(string name);
 		unsigned int getCurrentFrame() {return currentFrame;}
+		
+		/// frame sync: the current frame start time on the sync clock & direction
+		uint64_t getFrameTimestamp() {return timestamp;}
+		bool getForward() {return bForward;}
+		
+		/// frame sync: lock to a frame started at a time on the sync clock,
+		/// ignored if that frame has already ended, returns true if corrected
+		bool syncFrame(unsigned int num, uint64_t timestamp, bool forward, unsigned int maxSkew);
 
 		void setup();
 		void draw();
@@ -71,15 +79,15 @@ class Sprite : public DrawableObject {
 		void setDrawAllLayers(bool yesno) {bDrawAllLayers = yesno;}
 		
 		string getType() {return "sprite";}
+		
+		static const PropertyTable& getPropertyTable();
+		const PropertyTable& getProperties() {return getPropertyTable();}
 
 	protected:
 
 		/// resize child frames if height & width are set
 		void resizeIfNecessary();
 
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
-		
 		vector<DrawableFrame*> frames;
 
 		ofPoint pos;
@@ -91,6 +99,6 @@ class Sprite : public DrawableObject {
 		bool bDrawAllLayers;
 
 		int currentFrame;
-		unsigned int timestamp;
+		uint64_t timestamp; //< current frame start on the sync clock
 		bool bForward;  //< advance frames?
 };
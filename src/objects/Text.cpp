@@ -128,41 +128,16 @@ void Text::draw(int x, int y) {
 	}
 }
 
-// PROTECTED
 //--------------------------------------------------------------
-bool Text::processOscMessage(const ofxOscMessage& message) {
-
-	// call the base class
-	if(DrawableObject::processOscMessage(message)) {
-		return true;
-	}
-
-
-	if(message.getAddress() == oscRootAddress + "/position") {
-		tryNumber(message, pos.x, 0);
-		tryNumber(message, pos.y, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/x") {
-		tryNumber(message, pos.x, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/y") {
-		tryNumber(message, pos.y, 0);
-		return true;
-	}
-
-
-	else if(message.getAddress() == oscRootAddress + "/text") {
-		tryString(message, text, 0);
-		return true;
-	}
-	
-	else if(message.getAddress() == oscRootAddress + "/center") {
-		tryBool(message, bDrawFromCenter, 0);
-		return true;
-	}
-
-
-	return false;
+const PropertyTable& Text::getPropertyTable() {
+	static const Property properties[] = {
+		{"position", 0, NULL, {
+			PROPERTY_MEMBER(Text, "x", pos.x),
+			PROPERTY_MEMBER(Text, "y", pos.y)
+		}},
+		{"text", 0, NULL, {PROPERTY_MEMBER(Text, "", text)}},
+		{"center", 0, NULL, {PROPERTY_MEMBER(Text, "", bDrawFromCenter)}}
+	};
+	static const PropertyTable table(properties, 3, &DrawableObject::getPropertyTable());
+	return table;
 }
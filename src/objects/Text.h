@@ -58,12 +58,12 @@ class Text : public DrawableObject {
 		void setDrawFromCenter(bool c) {bDrawFromCenter = c;}
 		
 		string getType() {return "text";}
+		
+		static const PropertyTable& getPropertyTable();
+		const PropertyTable& getProperties() {return getPropertyTable();}
 
 	protected:
 
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
-
 		ofPtr<ofTrueTypeFont> font;
 		string fontFilename;
 		unsigned int fontSize;
@@ -183,82 +183,41 @@ void Video::setLoop(ofLoopType t) {
 }
 
 //--------------------------------------------------------------
-void Video::setSize(unsigned int w, unsigned int h) {
-	width = w;
-	height = h;
+float Video::getProgress() {
+	return video->isLoaded() ? video->getPosition() : 0;
 }
 
 //--------------------------------------------------------------
-bool Video::processOscMessage(const ofxOscMessage& message) {
-
-	// call the base class
-	if(DrawableObject::processOscMessage(message)) {
-		return true;
-	}
-
-	else if(message.getAddress() == oscRootAddress + "/play") {
-		bool b = bPlay;
-		if(tryBool(message, b, 0)) {
-			setPlay(b);
-		}
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/volume") {
-		float v = 0;
-		if(tryNumber(message, v, 0)) {
-			setVolume(v);
-		}
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/speed") {
-		float s = 0;
-		if(tryNumber(message, s, 0)) {
-			setSpeed(s);
-		}
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/loop") {
-		unsigned int l = (unsigned int) OF_LOOP_NONE;
-		if(tryNumber(message, l, 0)) {
-			setLoop((ofLoopType) l);
-		}
-		return true;
-	}
-
-	if(message.getAddress() == oscRootAddress + "/position") {
-		tryNumber(message, pos.x, 0);
-		tryNumber(message, pos.y, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/x") {
-		tryNumber(message, pos.x, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/position/y") {
-		tryNumber(message, pos.y, 0);
-		return true;
-	}
-	
-	
-	else if(message.getAddress() == oscRootAddress + "/size") {
-		tryNumber(message, width, 0);
-		tryNumber(message, height, 1);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/width") {
-		tryNumber(message, width, 0);
-		return true;
-	}
-	else if(message.getAddress() == oscRootAddress + "/size/height") {
-		tryNumber(message, height, 0);
-		return true;
+void Video::setProgress(float p) {
+	if(video->isLoaded()) {
+		video->setPosition(ofClamp(p, 0, 1));
 	}
+}
 
+//--------------------------------------------------------------
+void Video::setSize(unsigned int w, unsigned int h) {
+	width = w;
+	height = h;
+}
 
-	else if(message.getAddress() == oscRootAddress + "/center") {
-		tryBool(message, bDrawFromCenter, 0);
-		return true;
-	}
-
-	return false;
+//--------------------------------------------------------------
+const PropertyTable& Video::getPropertyTable() {
+	static const Property properties[] = {
+		{"play", 0, NULL, {PROPERTY_SETTER(Video, "", bPlay, setPlay)}},
+		{"volume", 0, NULL, {PROPERTY_SETTER(Video, "", volume, setVolume)}},
+		{"speed", 0, NULL, {PROPERTY_SETTER(Video, "", speed, setSpeed)}},
+		{"loop", 0, NULL, {PROPERTY_SETTER(Video, "", loopType, setLoop)}},
+		{"progress", 0, NULL, {PROPERTY_ACCESSOR(Video, "", float, getProgress, setProgress)}},
+		{"position", 0, NULL, {
+			PROPERTY_MEMBER(Video, "x", pos.x),
+			PROPERTY_MEMBER(Video, "y", pos.y)
+		}},
+		{"size", 0, NULL, {
+			PROPERTY_MEMBER(Video, "width", width),
+			PROPERTY_MEMBER(Video, "height", height)
+		}},
+		{"center", 0, NULL, {PROPERTY_MEMBER(Video, "", bDrawFromCenter)}}
+	};
+	static const PropertyTable table(properties, 8, &DrawableObject::getPropertyTable());
+	return table;
 }
@@ -57,6 +57,8 @@ class Video : public DrawableObject {
 		void setSpeed(float s);
 		ofLoopType getLoop();
 		void setLoop(ofLoopType s);
+		float getProgress(); //< playback position 0-1
+		void setProgress(float p);
 		
 		string getFilename() {return filename;}
 		
@@ -74,13 +76,13 @@ class Video : public DrawableObject {
 		
 		string getType() {return "video";}
 		
+		static const PropertyTable& getPropertyTable();
+		const PropertyTable& getProperties() {return getPropertyTable();}
+		
 		bool shouldAlwaysBeSetup() {return true;}
 
 	protected:
 
-		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
-		
 		ofPtr<ofVideoPlayer> video;
 
 		bool bPlay;
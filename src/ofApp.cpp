@@ -35,6 +35,7 @@ ofApp::ofApp() : config(Config::instance()),
 	bDebug = false;
 	bRunning = true;
 	reloadTimestamp = 0;
+	statsTimestamp = 0;
 	saveTimestamp = 0;
 	bUpdateCursor = false;
 	bUpdateWindowShape = false;
@@ -115,10 +116,48 @@ void ofApp::setup() {
 	
 	// setup the osc receiver
 	receiver.setup(config.listeningPort);
+	receiver.setQueueSize(config.oscQueueSize);
+	receiver.setReceiveBufferSize(config.oscReceiveBufferSize);
+	for(unsigned int i = 0; i < config.listeners.size(); ++i) {
+		receiver.addUdpListener(config.listeners[i].port, config.listeners[i].subtree);
+	}
+	if(config.tcpListeningPort > 0) {
+		receiver.addTcpListener(config.tcpListeningPort);
+	}
+	if(config.shmName != "") {
+		receiver.addShmListener(config.shmName, config.shmSize);
+	}
+	if(config.oscReplayFile != "") {
+		receiver.addReplayListener(config.oscReplayFile, config.oscReplayFast);
+	}
+	if(config.oscRecordFile != "") {
+		receiver.startRecording(config.oscRecordFile);
+	}
+	receiver.setCoalesce(config.oscCoalesce);
+	receiver.getLatency().setEnabled(config.oscLatencyStats);
+	receiver.getStats().setEnabled(config.oscTrafficStats || config.oscStatsInterval > 0);
+	receiver.getBacklog().setCapacity(config.oscBacklogSize, config.oscBacklogTriggers);
+	receiver.getBacklog().setOverflow(config.oscBacklogDropNewest ?
+		OscBacklog::DROP_NEWEST : OscBacklog::DROP_OLDEST);
+	setupOscTriggers();
 	receiver.start();
 	
 	// setup the osc sender
 	sender.setup(config.sendingIp, config.sendingPort);
+	sender.setMaxBundleSize(config.oscMaxBundleSize);
+	if(config.oscSendImmediate) {
+		sender.setFlushPolicy(OscSender::FLUSH_IMMEDIATE);
+	}
+	else if(config.oscSendInterval > 0) {
+		sender.setFlushPolicy(OscSender::FLUSH_INTERVAL, config.oscSendInterval);
+	}
+	
+	// setup frame sync with other instances
+	if(config.syncMode != "") {
+		config.frameSync.setMaxSkew(config.syncMaxSkew);
+		config.frameSync.setup(config.syncMode == "leader" ? FrameSync::LEADER : FrameSync::FOLLOWER,
+			config.syncGroup, config.syncPort);
+	}
 	
 	// setup & try to load first scene
 	sceneManager.showSceneName(config.showSceneNames);
@@ -158,11 +197,34 @@ void ofApp::update() {
 		}
 		bUpdateCursor = false;
 	}
+	
+	// the last frame has been swapped, then
+	// process osc messages received since the last frame
+	receiver.getLatency().swapped();
+	receiver.setPresentationDelay(ofGetLastFrameTime()); // shown a frame from now
+	receiver.update();
+	
+	// scene changes & script loads queued by the messages & keys
+	processCommands();
+	
+	// periodic traffic stats
+	if(config.oscStatsInterval > 0 &&
+	   ofGetElapsedTimeMillis() - statsTimestamp >= config.oscStatsInterval * 1000) {
+		sendOscStats(true);
+		statsTimestamp = ofGetElapsedTimeMillis();
+	}
+	scriptEngine.flushOsc();
 
 	if(bRunning) {
+		config.frameSync.update(sceneManager, commands); // before the sprites & videos update
 		sceneManager.update();
 //			config.resourceManager.update();
 		scriptEngine.lua.scriptUpdate();
+		
+		// changed properties go out in this frame's bundle
+		if(config.oscMirror) {
+			sceneManager.mirrorState(sender, config.oscMirrorRate);
+		}
 	}
 }
 
@@ -181,7 +243,38 @@ void ofApp::draw() {
 		ofDrawBitmapStringHighlight(ofToString((int) ofGetFrameRate()), 0, 12);
 		
 		if(!bRunning) {
-			ofDrawBitmapStringHighlight("Paused", 0, ofGetHeight()-22);
+			ofDrawBitmapStringHighlight("Paused, OSC backlog: "+ofToString(receiver.getBacklog().size()),
+				0, ofGetHeight()-22);
+		}
+		
+		if(receiver.getNumDropped() > 0 || receiver.getNumSocketDropped() > 0) {
+			ofDrawBitmapStringHighlight("OSC dropped: "+ofToString(receiver.getNumDropped())
+				+" socket: "+ofToString(receiver.getNumSocketDropped()), 0, 28);
+		}
+		if(receiver.getCoalesce()) {
+			ofDrawBitmapStringHighlight("OSC coalesced: "+ofToString(receiver.getNumCoalesced()), 0, 44);
+		}
+		if(sender.getNumDropped() > 0) {
+			ofDrawBitmapStringHighlight("OSC send dropped: "+ofToString(sender.getNumDropped()), 0, 60);
+		}
+		if(receiver.getLatency().isEnabled()) {
+			const OscLatency::Stats &total = receiver.getLatency().getTotal();
+			string text = "OSC latency ms p50/p99";
+			for(unsigned int s = 0; s < OscLatency::NUM_STAGES; ++s) {
+				const OscLatencyHistogram &h = total.stages[s];
+				text += " " + OscLatency::getStageName((OscLatency::Stage) s) + ": "
+					+ ofToString(h.getPercentile(0.5) / 1000.0, 1) + "/"
+					+ ofToString(h.getPercentile(0.99) / 1000.0, 1);
+			}
+			ofDrawBitmapStringHighlight(text, 0, 76);
+		}
+		if(config.frameSync.getMode() == FrameSync::FOLLOWER) {
+			ofDrawBitmapStringHighlight("Sync leader: "+ofToString(config.frameSync.getLeaderId())
+				+" skew: "+ofToString(config.frameSync.getSkew())+" ms", 0, 92);
+		}
+		if(sceneManager.getMaxSetupTime() > 0) {
+			ofDrawBitmapStringHighlight("Scene setup ms: "+ofToString(sceneManager.getSetupTime() / 1000.0, 1)
+				+" max: "+ofToString(sceneManager.getMaxSetupTime() / 1000.0, 1), 0, 108);
 		}
 		
 		Scene *s = sceneManager.getCurrentScene();
@@ -192,6 +285,12 @@ void ofApp::draw() {
 			ofDrawBitmapStringHighlight(ofFilePath::getFileName(config.script), 0, ofGetHeight()-6);
 		}
 	}
+	
+	// messages dispatched this frame have been drawn
+	receiver.getLatency().drawn();
+	
+	// send osc messages queued this frame
+	sender.update();
 }
 
 //--------------------------------------------------------------
@@ -206,6 +305,9 @@ void ofApp::exit() {
 
 	scriptEngine.lua.scriptExit();
 	receiver.stop();
+	receiver.stopRecording();
+	config.frameSync.stop();
+	sender.stop(); // sends anything left
 	sceneManager.clear();
 	
 	ofLogVerbose(PACKAGE) << "exiting ...";
@@ -303,6 +405,10 @@ void ofApp::keyPressed(int key) {
 		case 'd':
 			if(editor.isHidden() && modifierPressed) {
 				bDebug = !bDebug;
+				
+				// show latency in the overlay, only keep it on afterwards if
+				// it was asked for
+				receiver.getLatency().setEnabled(bDebug || config.oscLatencyStats);
 				bUpdateCursor = true;
 				ofLogVerbose(PACKAGE) << "Debug: " << bDebug;
 				return;
@@ -313,7 +419,7 @@ void ofApp::keyPressed(int key) {
 			// reload script & execute
 			if(modifierPressed && shiftPressed) {
 				if(ofGetElapsedTimeMillis() - reloadTimestamp > RELOAD_TIMEOUT_MS) {
-					reloadScript();
+					commands.push(Command(Command::RELOAD_SCRIPT));
 					reloadTimestamp = ofGetElapsedTimeMillis();
 					return;
 				}
@@ -441,6 +547,20 @@ void ofApp::openFileEvent(int &whichEditor){
 	ofLogVerbose(PACKAGE) << "ScriptEngine: current dir: \"" << currentDir << "\"";
 }
 
+//--------------------------------------------------------------
+void ofApp::setupOscTriggers() {
+	const string &root = getOscRootAddress();
+	receiver.clearTriggers();
+	receiver.addTrigger(root+"/scene");
+	receiver.addTrigger(root+"/scene/prev");
+	receiver.addTrigger(root+"/scene/next");
+	receiver.addTrigger(root+"/scene/object/prev");
+	receiver.addTrigger(root+"/scene/object/next");
+	receiver.addTrigger(root+"/file");
+	receiver.addTrigger(root+"/reload");
+	receiver.addTrigger(root+"/quit");
+}
+
 //--------------------------------------------------------------
 void ofApp::saveFileEvent(int &whichEditor){
 	ofLogVerbose(PACKAGE) << "editor " << whichEditor << ": saved "
@@ -524,78 +644,272 @@ void ofApp::unloadScript() {
 
 // PROTECTED
 //--------------------------------------------------------------
-// lock scene changes with the mutex to make sure the lua state is
-// closed before calling lua functions
-bool ofApp::processOscMessage(const ofxOscMessage& message) {
+void ofApp::processCommands() {
+	uint64_t start = ofGetElapsedTimeMicros();
+	while(!commands.empty()) {
+		if(commands.front().isSetup() && config.setupBudget > 0 &&
+		   ofGetElapsedTimeMicros() - start >= config.setupBudget * 1000) {
+			ofLogVerbose(PACKAGE) << "setup budget spent, " << commands.size()
+				<< " command(s) wait for the next frame";
+			break;
+		}
+		Command command = commands.front();
+		commands.pop();
+		runCommand(command);
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::runCommand(const Command &command) {
+	switch(command.type) {
+		case Command::GOTO_SCENE:
+			if(command.index >= 0) {
+				sceneManager.gotoScene((unsigned int) command.index);
+			}
+			else {
+				sceneManager.gotoScene(command.name);
+			}
+			break;
+		case Command::NEXT_SCENE:
+			sceneManager.nextScene();
+			break;
+		case Command::PREV_SCENE:
+			sceneManager.prevScene();
+			break;
+		case Command::FOLLOW_SCENE:
+			sceneManager.followScene(command.name, command.index);
+			break;
+		case Command::LOAD_SCRIPT:
+			loadScript(command.name);
+			break;
+		case Command::RELOAD_SCRIPT:
+			reloadScript();
+			break;
+		case Command::EXIT:
+			ofExit();
+			break;
+		case Command::NONE:
+			break;
+	}
+}
+
+//--------------------------------------------------------------
+// called from receiver.update() on the main thread, so scene changes & lua
+// calls don't race with draw()
+bool ofApp::processOscMessage(const OscMessage& message) {
 
 #ifdef DEBUG
 	ofLogVerbose(PACKAGE) << "received " << message.getAddress();
 #endif
 	
-	if(message.getAddress() == getOscRootAddress() + "/scene") {
-		string name;
-		int index;
-		if(OscObject::tryString(message, name, 0)) {
-			sceneManager.gotoScene(name);
+	switch(getOscCommands().find(getOscRootAddress(), message.getAddress())) {
+	
+		case OSC_SCENE: {
+			string name;
+			int index;
+			if(OscObject::tryString(message, name, 0)) {
+				commands.push(Command(Command::GOTO_SCENE, name));
+				return true;
+			}
+			else if(OscObject::tryNumber(message, index, 0)) {
+				if(index > -1) {
+					commands.push(Command(Command::GOTO_SCENE, "", index));
+				}
+				return true;
+			}
+			break;
+		}
+		
+		case OSC_SCENE_PREV:
+			// ignore TouchOsc "button off" events
+			if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+				return true;
+			}
+			commands.push(Command(Command::PREV_SCENE));
+			return true;
+		
+		case OSC_SCENE_NEXT:
+			// ignore TouchOsc "button off" events
+			if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+				return true;
+			}
+			commands.push(Command(Command::NEXT_SCENE));
+			return true;
+		
+		case OSC_FILE: {
+			string script;
+			if(tryString(message, script, 0)) {
+				commands.push(Command(Command::LOAD_SCRIPT, script));
+			}
 			return true;
 		}
-		else if(OscObject::tryNumber(message, index, 0)) {
-			if(index > -1) {
-				sceneManager.gotoScene(index);
+		
+		case OSC_RELOAD:
+			commands.push(Command(Command::RELOAD_SCRIPT));
+			return true;
+		
+		case OSC_FRAMERATE: {
+			unsigned int fps;
+			if(OscObject::tryNumber(message, fps, 0)) {
+				sceneManager.setFrameRate(fps);
 			}
 			return true;
 		}
-	}
-	
-	else if(message.getAddress() == getOscRootAddress() + "/scene/prev") {
-		// ignore TouchOsc "button off" events
-		if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+		
+		case OSC_QUIT:
+			commands.push(Command(Command::EXIT));
+			return true;
+		
+		case OSC_STATS_LATENCY: {
+			string address;
+			tryString(message, address, 0);
+			sendLatencyStats(address);
+			return true;
+		}
+		case OSC_STATS_LATENCY_ENABLE:
+			if(tryBool(message, config.oscLatencyStats, 0)) {
+				receiver.getLatency().setEnabled(bDebug || config.oscLatencyStats);
+			}
+			return true;
+		case OSC_STATS_LATENCY_CLEAR:
+			receiver.getLatency().clear();
+			return true;
+		
+		case OSC_STATS_OSC:
+			sendOscStats();
+			return true;
+		case OSC_STATS_OSC_ENABLE:
+			if(tryBool(message, config.oscTrafficStats, 0)) {
+				receiver.getStats().setEnabled(config.oscTrafficStats || config.oscStatsInterval > 0);
+			}
+			return true;
+		case OSC_STATS_OSC_CLEAR:
+			receiver.getStats().clear();
+			return true;
+		
+		case OSC_STATE_DUMP: {
+			// optional "all" or true to dump every scene instead of the current one
+			string which;
+			bool all = false;
+			if(tryString(message, which, 0)) {
+				all = (which == "all");
+			}
+			else {
+				tryBool(message, all, 0);
+			}
+			sceneManager.sendState(sender, all);
 			return true;
 		}
-		sceneManager.prevScene();
+		case OSC_STATE_MIRROR:
+			tryBool(message, config.oscMirror, 0);
+			return true;
+		case OSC_STATE_MIRROR_RATE:
+			tryNumber(message, config.oscMirrorRate, 0);
+			return true;
+		
+		default:
+			break;
+	}
+	
+	if(sceneManager.processOsc(message)) {
 		return true;
 	}
 	
-	else if(message.getAddress() == getOscRootAddress() + "/scene/next") {
-		// ignore TouchOsc "button off" events
-		if(message.getArgType(0) == OFXOSC_TYPE_FLOAT && message.getArgAsFloat(0) == 0) {
+	// forward message to lua, only a bound handler consumes it, the
+	// oscReceived callbacks may ignore it so count it separately
+	switch(scriptEngine.sendOsc(message)) {
+		case ScriptEngine::OSC_BOUND:
 			return true;
-		}
-		sceneManager.nextScene();
-		return true;
+		case ScriptEngine::OSC_CALLBACK:
+			receiver.getStats().forwarded();
+			return false;
+		default:
+			return false;
 	}
+}
 
-	else if(message.getAddress() == getOscRootAddress() + "/file") {
-		if(tryString(message, config.script, 0)) {
-			loadScript(config.script);
-		}
-		return true;
+//--------------------------------------------------------------
+const OscCommandTable& ofApp::getOscCommands() {
+	static OscCommandTable table;
+	if(table.size() == 0) {
+		table.add("/scene", OSC_SCENE);
+		table.add("/scene/prev", OSC_SCENE_PREV);
+		table.add("/scene/next", OSC_SCENE_NEXT);
+		table.add("/file", OSC_FILE);
+		table.add("/reload", OSC_RELOAD);
+		table.add("/framerate", OSC_FRAMERATE);
+		table.add("/quit", OSC_QUIT);
+		table.add("/stats/latency", OSC_STATS_LATENCY);
+		table.add("/stats/latency/enable", OSC_STATS_LATENCY_ENABLE);
+		table.add("/stats/latency/clear", OSC_STATS_LATENCY_CLEAR);
+		table.add("/stats/osc", OSC_STATS_OSC);
+		table.add("/stats/osc/enable", OSC_STATS_OSC_ENABLE);
+		table.add("/stats/osc/clear", OSC_STATS_OSC_CLEAR);
+		table.add("/state/dump", OSC_STATE_DUMP);
+		table.add("/state/mirror", OSC_STATE_MIRROR);
+		table.add("/state/mirror/rate", OSC_STATE_MIRROR_RATE);
 	}
+	return table;
+}
+
+//--------------------------------------------------------------
+void ofApp::sendLatencyStats(const string &address) {
+	OscLatency &latency = receiver.getLatency();
 	
-	else if(message.getAddress() == getOscRootAddress() + "/reload") {
-		reloadScript();
-		return true;
+	// one message per address, "*" is the total
+	vector<pair<string, const OscLatency::Stats*> > stats;
+	if(address == "" || address == "*") {
+		stats.push_back(std::make_pair((string) "*", &latency.getTotal()));
 	}
-	
-	else if(message.getAddress() == getOscRootAddress() + "/framerate") {
-		unsigned int fps;
-		if(OscObject::tryNumber(message, fps, 0)) {
-			sceneManager.setFrameRate(fps);
+	if(address == "") {
+		for(OscLatency::const_iterator iter = latency.begin(); iter != latency.end(); ++iter) {
+			stats.push_back(std::make_pair(iter->first, &iter->second));
 		}
-		return true;
 	}
-
-	else if(message.getAddress() == getOscRootAddress() + "/quit") {
-		ofExit();
-		return true;
+	else if(address != "*") {
+		const OscLatency::Stats *s = latency.getStats(address);
+		if(s == NULL) {
+			ofLogWarning(PACKAGE) << "no latency stats for " << address;
+			return;
+		}
+		stats.push_back(std::make_pair(address, s));
 	}
 	
-	if(sceneManager.processOsc(message)) {
-		return true;
+	for(unsigned int i = 0; i < stats.size(); ++i) {
+		const OscLatency::Stats &s = *stats[i].second;
+		ofxOscMessage message;
+		message.setAddress(getOscRootAddress() + "/stats/latency");
+		message.addStringArg(stats[i].first);
+		message.addIntArg(s.stages[OscLatency::TOTAL].getCount());
+		for(unsigned int stage = 0; stage < OscLatency::NUM_STAGES; ++stage) {
+			message.addIntArg(s.stages[stage].getPercentile(0.5));
+			message.addIntArg(s.stages[stage].getPercentile(0.99));
+		}
+		sender.sendMessage(message);
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::sendOscStats(bool notification) {
+	receiver.getStats().snapshot(statsSnapshots);
+	for(unsigned int i = 0; i < statsSnapshots.size(); ++i) {
+		const OscStats::Snapshot &s = statsSnapshots[i];
+		ofxOscMessage message;
+		if(notification) {
+			message.setAddress(config.notificationAddress);
+			message.addStringArg("stats");
+			message.addIntArg(config.connectionId);
+		}
+		else {
+			message.setAddress(getOscRootAddress() + "/stats/osc");
+		}
+		message.addStringArg(s.prefix);
+		message.addIntArg(s.count);
+		message.addFloatArg(s.rate);
+		message.addIntArg(s.handled);
+		message.addIntArg(s.unhandled);
+		message.addInt64Arg(s.time);
+		message.addIntArg(s.forwarded);
+		sender.sendMessage(message);
 	}
-	
-	// forward message to lua
-	scriptEngine.sendOsc(message);
-	
-	return true;
 }
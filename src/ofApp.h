@@ -26,7 +26,9 @@
 #include "ofxGLEditor.h"
 
 #include "Config.h"
+#include "CommandQueue.h"
 #include "OscReceiver.h"
+#include "OscCommandTable.h"
 #include "SceneManager.h"
 #include "ScriptEngine.h"
 
@@ -55,6 +57,9 @@ class ofApp : public ofBaseApp, public ofxGLEditorListener, public OscObject {
 		void reloadScript();
 		void unloadScript();
 		
+		/// (re)register the transport addresses which are never coalesced
+		void setupOscTriggers();
+		
 		/// editor events
 		void saveFileEvent(int &whichEditor);
 		void openFileEvent(int &whichEditor);
@@ -66,10 +71,11 @@ class ofApp : public ofBaseApp, public ofxGLEditorListener, public OscObject {
 		
 		Config &config;
 		OscReceiver &receiver;
-		ofxOscSender &sender;
+		OscSender &sender;
 		ScriptEngine &scriptEngine;
 		
 		SceneManager sceneManager;
+		CommandQueue commands; //< deferred scene transport & script commands
 		
 		unsigned int reloadTimestamp;
 		unsigned int saveTimestamp;
@@ -86,6 +92,47 @@ class ofApp : public ofBaseApp, public ofxGLEditorListener, public OscObject {
 		
 	protected:
 	
+		/// run queued commands in order until the setup budget for this frame
+		/// is spent, the rest wait for the next frame
+		void processCommands();
+		
+		/// run a single command
+		void runCommand(const Command &command);
+		
 		/// osc callback
-		bool processOscMessage(const ofxOscMessage& message);
+		bool processOscMessage(const OscMessage& message);
+		
+		/// osc commands by address relative to the root address
+		enum OscCommand {
+			OSC_SCENE,
+			OSC_SCENE_PREV,
+			OSC_SCENE_NEXT,
+			OSC_FILE,
+			OSC_RELOAD,
+			OSC_FRAMERATE,
+			OSC_QUIT,
+			OSC_STATS_LATENCY,
+			OSC_STATS_LATENCY_ENABLE,
+			OSC_STATS_LATENCY_CLEAR,
+			OSC_STATS_OSC,
+			OSC_STATS_OSC_ENABLE,
+			OSC_STATS_OSC_CLEAR,
+			OSC_STATE_DUMP,
+			OSC_STATE_MIRROR,
+			OSC_STATE_MIRROR_RATE
+		};
+		static const OscCommandTable& getOscCommands();
+		
+		/// send latency stats for all addresses, or a given address, to the
+		/// sending address as "<root>/stats/latency address count" followed
+		/// by p50 & p99 microseconds for each stage
+		void sendLatencyStats(const string &address="");
+		
+		/// send traffic stats for each address prefix, either to the sending
+		/// address as "<root>/stats/osc prefix count rate handled unhandled
+		/// time forwarded" or as a notification with "stats" & the connection
+		/// id first, forwarded messages only went to the lua callbacks
+		void sendOscStats(bool notification=false);
+		vector<OscStats::Snapshot> statsSnapshots; //< reused
+		unsigned long long statsTimestamp; //< last stats notification
 };
@@ -0,0 +1,118 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscAddressMap.h"
+
+#include "OscObject.h"
+
+// max number of resolved addresses to cache before starting over
+#define ADDRESS_CACHE_SIZE 2048
+
+//--------------------------------------------------------------
+void OscAddressMap::add(OscObject *object) {
+	if(object == NULL) {
+		return;
+	}
+	roots[object->getOscRootAddress()].push_back(object);
+	cache.clear();
+}
+
+//--------------------------------------------------------------
+void OscAddressMap::remove(OscObject *object) {
+	if(object == NULL) {
+		return;
+	}
+	
+	// the root may have changed since it was added, so check all entries
+	unordered_map<string, vector<OscObject*> >::iterator iter;
+	for(iter = roots.begin(); iter != roots.end(); ++iter) {
+		vector<OscObject*> &objects = iter->second;
+		vector<OscObject*>::iterator found = std::find(objects.begin(), objects.end(), object);
+		if(found != objects.end()) {
+			objects.erase(found);
+			if(objects.empty()) {
+				roots.erase(iter);
+			}
+			break;
+		}
+	}
+	cache.clear();
+}
+
+//--------------------------------------------------------------
+void OscAddressMap::clear() {
+	roots.clear();
+	cache.clear();
+}
+
+//--------------------------------------------------------------
+const vector<OscObject*>* OscAddressMap::find(const string &address) {
+	if(roots.empty()) {
+		return NULL;
+	}
+	
+	// cached?
+	unordered_map<string, const vector<OscObject*>* >::iterator iter = cache.find(address);
+	if(iter != cache.end()) {
+		return iter->second;
+	}
+	
+	const vector<OscObject*> *objects = resolve(address);
+	if(cache.size() >= ADDRESS_CACHE_SIZE) {
+		cache.clear();
+	}
+	cache[address] = objects;
+	return objects;
+}
+
+//--------------------------------------------------------------
+const vector<OscObject*>* OscAddressMap::findParent(const string &rootAddress) {
+	if(rootAddress.empty()) {
+		return NULL; // nothing above the empty root
+	}
+	string::size_type slash = rootAddress.find_last_of('/');
+	if(slash == string::npos) {
+		slash = 0;
+	}
+	return resolve(rootAddress.substr(0, slash));
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+const vector<OscObject*>* OscAddressMap::resolve(const string &address) {
+	string prefix = address;
+	while(true) {
+		unordered_map<string, vector<OscObject*> >::iterator iter = roots.find(prefix);
+		if(iter != roots.end()) {
+			return &iter->second;
+		}
+		if(prefix.empty()) {
+			break;
+		}
+		string::size_type slash = prefix.find_last_of('/');
+		if(slash == string::npos) {
+			slash = 0;
+		}
+		prefix.erase(slash);
+	}
+	return NULL;
+}
@@ -0,0 +1,70 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include <unordered_map>
+
+class OscObject;
+
+/// hash index of attached OscObjects keyed by their root addresses
+///
+/// a message address is resolved to the objects whose root is the longest
+/// matching prefix, ie. "/visual/scene1/rect/color" -> "/visual/scene1/rect",
+/// resolved addresses are cached so repeat lookups are a single hash lookup
+class OscAddressMap {
+
+	public:
+	
+		OscAddressMap() {}
+	
+		/// add/remove an object using its current root address
+		void add(OscObject *object);
+		void remove(OscObject *object);
+		
+		/// clear all objects & cached addresses
+		void clear();
+		
+		/// find the objects for a given message address, returns NULL if none
+		const vector<OscObject*>* find(const string &address);
+		
+		/// find the objects for the next shorter root address above a given
+		/// root address, used to fall through when no object handles a message
+		const vector<OscObject*>* findParent(const string &rootAddress);
+		
+		/// number of unique root addresses
+		unsigned int size() {return roots.size();}
+		
+		/// iterate over root address -> objects
+		typedef unordered_map<string, vector<OscObject*> >::const_iterator const_iterator;
+		const_iterator begin() const {return roots.begin();}
+		const_iterator end() const {return roots.end();}
+	
+	protected:
+	
+		/// walk up through the address segments to find the longest root
+		const vector<OscObject*>* resolve(const string &address);
+	
+		unordered_map<string, vector<OscObject*> > roots; //< root -> objects
+		unordered_map<string, const vector<OscObject*>* > cache; //< address -> objects
+};
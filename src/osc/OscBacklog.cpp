@@ -0,0 +1,158 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscBacklog.h"
+
+// default capacities
+#define DEFAULT_ADDRESS_CAPACITY 1024
+#define DEFAULT_TRIGGER_CAPACITY 256
+
+//--------------------------------------------------------------
+OscBacklog::OscBacklog() : m_addressCapacity(0), m_triggerCapacity(0),
+	m_overflow(DROP_OLDEST), m_order(0), m_numDropped(0) {
+	setCapacity(DEFAULT_ADDRESS_CAPACITY, DEFAULT_TRIGGER_CAPACITY);
+}
+
+//--------------------------------------------------------------
+void OscBacklog::setCapacity(unsigned int addresses, unsigned int triggers) {
+	m_values.clear();
+	m_triggers.clear();
+	m_addressCapacity = addresses;
+	m_triggerCapacity = (addresses > 0 ? triggers : 0);
+	
+	// entries are allocated up front & never moved so pointers to them stay
+	// valid, their data is only allocated when used
+	m_entries.clear();
+	m_entries.resize(m_addressCapacity + m_triggerCapacity);
+	m_free.clear();
+	for(unsigned int i = 0; i < m_entries.size(); ++i) {
+		m_free.push_back(&m_entries[m_entries.size()-1-i]);
+	}
+	m_values.reserve(m_addressCapacity);
+	m_numDropped = 0;
+}
+
+//--------------------------------------------------------------
+bool OscBacklog::add(const char *data, unsigned int size, const string &address,
+                     const osc::IpEndpointName &endpoint, uint64_t time, bool trigger) {
+	if(!isEnabled() || size > OSC_MAX_PACKET_SIZE) {
+		m_numDropped++;
+		return false;
+	}
+	Entry *entry = NULL;
+	if(trigger) {
+		if(m_triggers.size() >= m_triggerCapacity) {
+			if(m_overflow == DROP_NEWEST || m_triggers.empty()) {
+				m_numDropped++;
+				return false;
+			}
+			entry = m_triggers.front();
+			m_triggers.pop_front();
+			m_numDropped++;
+		}
+		else {
+			entry = getFreeEntry();
+		}
+		m_triggers.push_back(entry);
+	}
+	else {
+		unordered_map<string, Entry*>::iterator iter = m_values.find(address);
+		if(iter != m_values.end()) {
+			entry = iter->second;
+		}
+		else {
+			if(m_values.size() >= m_addressCapacity) {
+				if(m_overflow == DROP_NEWEST) {
+					m_numDropped++;
+					return false;
+				}
+				
+				// replace the least recently updated address
+				iter = m_values.begin();
+				for(unordered_map<string, Entry*>::iterator i = m_values.begin();
+					i != m_values.end(); ++i) {
+					if(i->second->order < iter->second->order) {
+						iter = i;
+					}
+				}
+				entry = iter->second;
+				m_values.erase(iter);
+				m_numDropped++;
+			}
+			else {
+				entry = getFreeEntry();
+			}
+			m_values[address] = entry;
+		}
+	}
+	if(entry->data.size() < size) {
+		entry->data.resize(size);
+	}
+	memcpy(&entry->data[0], data, size);
+	entry->size = size;
+	entry->endpoint = endpoint;
+	entry->time = time;
+	entry->order = m_order++;
+	entry->address = address; // reuses capacity
+	entry->bTrigger = trigger;
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscBacklog::getEntries(vector<const Entry*> &entries) {
+	entries.clear();
+	for(unordered_map<string, Entry*>::iterator iter = m_values.begin();
+		iter != m_values.end(); ++iter) {
+		entries.push_back(iter->second);
+	}
+	for(unsigned int i = 0; i < m_triggers.size(); ++i) {
+		entries.push_back(m_triggers[i]);
+	}
+	sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) {
+		return a->order < b->order;
+	});
+}
+
+//--------------------------------------------------------------
+void OscBacklog::clear() {
+	for(unordered_map<string, Entry*>::iterator iter = m_values.begin();
+		iter != m_values.end(); ++iter) {
+		m_free.push_back(iter->second);
+	}
+	for(unsigned int i = 0; i < m_triggers.size(); ++i) {
+		m_free.push_back(m_triggers[i]);
+	}
+	m_values.clear();
+	m_triggers.clear();
+	m_numDropped = 0;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+OscBacklog::Entry* OscBacklog::getFreeEntry() {
+	if(m_free.empty()) {
+		return NULL;
+	}
+	Entry *entry = m_free.back();
+	m_free.pop_back();
+	return entry;
+}
@@ -0,0 +1,104 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+#include <unordered_map>
+#include <deque>
+
+/// a bounded backlog of messages held while the receiver is ignoring them,
+/// ie. when paused, to be applied together when resumed
+///
+/// only the newest message is kept for each address, except for triggers
+/// which are all kept in order, so a long pause holds at most the capacity
+/// worth of messages & reuses their storage
+///
+/// when full, either new addresses & triggers are dropped or the least
+/// recently updated address or oldest trigger is replaced
+class OscBacklog {
+
+	public:
+	
+		/// what to drop when full
+		enum Overflow {
+			DROP_NEWEST, //< drop incoming messages for new addresses/triggers
+			DROP_OLDEST  //< replace the least recently updated address/oldest trigger
+		};
+		
+		/// a held message copy
+		struct Entry {
+			vector<char> data; //< message bytes, only grows
+			unsigned int size;
+			osc::IpEndpointName endpoint;
+			uint64_t time; //< receive time
+			uint64_t order; //< arrival order
+			string address;
+			bool bTrigger;
+		};
+		
+		OscBacklog();
+		
+		/// set the max number of addresses & triggers held,
+		/// 0 addresses disables the backlog, clears the backlog
+		void setCapacity(unsigned int addresses, unsigned int triggers);
+		unsigned int getAddressCapacity() {return m_addressCapacity;}
+		unsigned int getTriggerCapacity() {return m_triggerCapacity;}
+		bool isEnabled() {return m_addressCapacity > 0;}
+		
+		void setOverflow(Overflow overflow) {m_overflow = overflow;}
+		Overflow getOverflow() {return m_overflow;}
+		
+		/// hold a copy of a message, replacing any held for the same address
+		/// unless it's a trigger, messages larger than OSC_MAX_PACKET_SIZE are
+		/// dropped, returns false if dropped
+		bool add(const char *data, unsigned int size, const string &address,
+		         const osc::IpEndpointName &endpoint, uint64_t time, bool trigger);
+		
+		/// get the held messages in arrival order,
+		/// valid until the next add() or clear()
+		void getEntries(vector<const Entry*> &entries);
+		
+		/// drop all held messages, keeps the storage
+		void clear();
+		
+		/// number of held messages
+		unsigned int size() {return m_values.size() + m_triggers.size();}
+		bool empty() {return size() == 0;}
+		
+		/// messages dropped due to overflow or size since the last clear
+		unsigned int getNumDropped() {return m_numDropped;}
+	
+	protected:
+	
+		/// get an unused entry, returns NULL if none
+		Entry* getFreeEntry();
+	
+		vector<Entry> m_entries; //< storage for all held messages
+		vector<Entry*> m_free; //< unused entries
+		unordered_map<string, Entry*> m_values; //< address -> newest message
+		deque<Entry*> m_triggers; //< in arrival order
+		unsigned int m_addressCapacity, m_triggerCapacity;
+		Overflow m_overflow;
+		uint64_t m_order;
+		unsigned int m_numDropped;
+};
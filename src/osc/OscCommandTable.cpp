@@ -0,0 +1,55 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscCommandTable.h"
+
+//--------------------------------------------------------------
+void OscCommandTable::add(const string &address, int id) {
+	for(unsigned int i = 0; i < entries.size(); ++i) {
+		if(entries[i].address == address) {
+			entries[i].id = id;
+			return;
+		}
+	}
+	Entry entry;
+	entry.address = address;
+	entry.id = id;
+	entries.push_back(entry);
+	hashIndex.add(oscHashAddress(address.c_str()));
+}
+
+//--------------------------------------------------------------
+int OscCommandTable::find(const string &rootAddress, const string &address) const {
+	if(address.size() <= rootAddress.size() || address[rootAddress.size()] != '/' ||
+	   address.compare(0, rootAddress.size(), rootAddress) != 0) {
+		return -1;
+	}
+	return find(address.c_str() + rootAddress.size());
+}
+
+//--------------------------------------------------------------
+int OscCommandTable::find(const char *relative) const {
+	int index = hashIndex.find(oscHashAddress(relative), [this, relative](int i) {
+		return entries[i].address == relative;
+	});
+	return index < 0 ? -1 : entries[index].id;
+}
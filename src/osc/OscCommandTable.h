@@ -0,0 +1,61 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include "OscHash.h"
+
+/// command addresses relative to an object root, ie. "/stats/osc/clear",
+/// mapped to ids so handling a message is a prefix compare & a single hash
+/// lookup instead of building & comparing each full address in turn
+///
+/// build once, ie. as a function static, then switch on the found id
+class OscCommandTable {
+
+	public:
+	
+		/// add a command address & id, ie. add("/reload", RELOAD)
+		void add(const string &address, int id);
+		
+		/// find the command id for a message address within a root address,
+		/// ie. "/visual" & "/visual/reload", returns -1 if not found
+		int find(const string &rootAddress, const string &address) const;
+		
+		/// find the command id for an address relative to the root,
+		/// ie. "/reload", returns -1 if not found
+		int find(const char *relative) const;
+		
+		/// number of commands
+		unsigned int size() const {return entries.size();}
+	
+	protected:
+	
+		/// a command address & its id
+		struct Entry {
+			string address;
+			int id;
+		};
+		
+		vector<Entry> entries;
+		OscHashIndex hashIndex; //< entry indices by address hash
+};
@@ -0,0 +1,105 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+/// FNV-1a hash of an address
+inline uint32_t oscHashAddress(const char *address) {
+	uint32_t hash = 2166136261u;
+	for(; *address != '\0'; ++address) {
+		hash = (hash ^ (unsigned char) *address) * 16777619u;
+	}
+	return hash;
+}
+
+/// FNV-1a hash of the first length chars of an address
+inline uint32_t oscHashAddress(const char *address, unsigned int length) {
+	uint32_t hash = 2166136261u;
+	for(unsigned int i = 0; i < length; ++i) {
+		hash = (hash ^ (unsigned char) address[i]) * 16777619u;
+	}
+	return hash;
+}
+
+/// open addressing hash index for a table of entries kept by its owner,
+/// ie. addresses, entries are added in order & found by their index
+///
+/// linear probing over a power of 2 number of slots kept at most half full
+class OscHashIndex {
+
+	public:
+	
+		/// add the hash of the next entry
+		void add(uint32_t hash) {
+			hashes.push_back(hash);
+			if(hashes.size()*2 > slots.size()) {
+				unsigned int size = 8;
+				while(size < hashes.size()*2) {
+					size *= 2;
+				}
+				slots.assign(size, -1);
+				for(unsigned int i = 0; i < hashes.size(); ++i) {
+					insert(i);
+				}
+			}
+			else {
+				insert(hashes.size()-1);
+			}
+		}
+		
+		/// find the index of the entry with a hash for which match(index) is
+		/// true, ie. the address is the same, returns -1 if not found
+		template<class Match>
+		int find(uint32_t hash, const Match &match) const {
+			if(slots.empty()) {
+				return -1;
+			}
+			unsigned int mask = slots.size()-1;
+			for(unsigned int i = hash & mask; slots[i] >= 0; i = (i+1) & mask) {
+				if(hashes[slots[i]] == hash && match(slots[i])) {
+					return slots[i];
+				}
+			}
+			return -1;
+		}
+		
+		/// number of entries
+		unsigned int size() const {return hashes.size();}
+	
+	protected:
+	
+		/// insert an entry into the first free slot from its hash
+		void insert(unsigned int index) {
+			unsigned int mask = slots.size()-1;
+			unsigned int s = hashes[index] & mask;
+			while(slots[s] >= 0) {
+				s = (s+1) & mask;
+			}
+			slots[s] = index;
+		}
+	
+		std::vector<uint32_t> hashes; //< entry hashes by index
+		std::vector<int> slots; //< entry indices by hash, -1 for empty
+};
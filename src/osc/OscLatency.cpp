@@ -0,0 +1,182 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscLatency.h"
+
+// default max number of addresses with their own stats
+#define DEFAULT_MAX_ADDRESSES 256
+
+// SUB_BUCKETS per power of 2, SUB_BITS = log2(SUB_BUCKETS)
+#define SUB_BUCKETS 4
+#define SUB_BITS 2
+
+//--------------------------------------------------------------
+void OscLatencyHistogram::add(uint64_t us) {
+	buckets[bucket(us)]++;
+	count++;
+	if(us > max) {
+		max = us;
+	}
+}
+
+//--------------------------------------------------------------
+uint64_t OscLatencyHistogram::getPercentile(float percentile) const {
+	if(count == 0) {
+		return 0;
+	}
+	unsigned int rank = (unsigned int) ceil(percentile * count);
+	if(rank < 1) {
+		rank = 1;
+	}
+	unsigned int seen = 0;
+	for(unsigned int i = 0; i < NUM_BUCKETS; ++i) {
+		seen += buckets[i];
+		if(seen >= rank) {
+			return std::min(bucketMax(i), max);
+		}
+	}
+	return max;
+}
+
+//--------------------------------------------------------------
+void OscLatencyHistogram::clear() {
+	memset(buckets, 0, sizeof(buckets));
+	count = 0;
+	max = 0;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+unsigned int OscLatencyHistogram::bucket(uint64_t us) {
+	if(us < SUB_BUCKETS) {
+		return us; // exact
+	}
+	
+	// power of 2 & the next bits below it
+	unsigned int msb = 63 - __builtin_clzll(us);
+	unsigned int sub = (us >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1);
+	unsigned int index = SUB_BUCKETS * (msb - SUB_BITS + 1) + sub;
+	return std::min(index, NUM_BUCKETS - 1);
+}
+
+//--------------------------------------------------------------
+uint64_t OscLatencyHistogram::bucketMax(unsigned int index) {
+	if(index < SUB_BUCKETS) {
+		return index;
+	}
+	unsigned int msb = index / SUB_BUCKETS + SUB_BITS - 1;
+	uint64_t sub = index % SUB_BUCKETS;
+	return ((SUB_BUCKETS + sub + 1) << (msb - SUB_BITS)) - 1;
+}
+
+//--------------------------------------------------------------
+OscLatency::OscLatency() : bEnabled(false),
+	maxAddresses(DEFAULT_MAX_ADDRESSES), drawTime(0) {}
+
+//--------------------------------------------------------------
+void OscLatency::setEnabled(bool enabled) {
+	bEnabled = enabled;
+	if(!bEnabled) {
+		dispatchedList.clear();
+		drawnList.clear();
+	}
+}
+
+//--------------------------------------------------------------
+void OscLatency::dispatched(const string &address, uint64_t readTime) {
+	Pending pending;
+	unordered_map<string, Stats>::iterator iter = addresses.find(address);
+	if(iter != addresses.end()) {
+		pending.stats = &iter->second;
+	}
+	else if(addresses.size() < maxAddresses) {
+		pending.stats = &addresses[address];
+	}
+	else {
+		pending.stats = NULL;
+	}
+	pending.readTime = readTime;
+	pending.dispatchTime = oscMonotonicTime();
+	dispatchedList.push_back(pending);
+}
+
+//--------------------------------------------------------------
+void OscLatency::drawn() {
+	if(!bEnabled) {
+		return;
+	}
+	drawTime = oscMonotonicTime();
+	
+	// anything not swapped yet was drawn again, count the latest draw
+	drawnList.insert(drawnList.end(), dispatchedList.begin(), dispatchedList.end());
+	dispatchedList.clear();
+}
+
+//--------------------------------------------------------------
+void OscLatency::swapped() {
+	if(drawnList.empty()) {
+		return;
+	}
+	uint64_t swapTime = oscMonotonicTime();
+	for(unsigned int i = 0; i < drawnList.size(); ++i) {
+		const Pending &p = drawnList[i];
+		uint64_t stages[NUM_STAGES];
+		stages[QUEUE] = p.dispatchTime - std::min(p.readTime, p.dispatchTime);
+		stages[DRAW] = drawTime - p.dispatchTime;
+		stages[SWAP] = swapTime - drawTime;
+		stages[TOTAL] = swapTime - std::min(p.readTime, p.dispatchTime);
+		for(unsigned int s = 0; s < NUM_STAGES; ++s) {
+			total.stages[s].add(stages[s]);
+			if(p.stats) {
+				p.stats->stages[s].add(stages[s]);
+			}
+		}
+	}
+	drawnList.clear();
+}
+
+//--------------------------------------------------------------
+const OscLatency::Stats* OscLatency::getStats(const string &address) const {
+	unordered_map<string, Stats>::const_iterator iter = addresses.find(address);
+	return iter != addresses.end() ? &iter->second : NULL;
+}
+
+//--------------------------------------------------------------
+void OscLatency::clear() {
+	dispatchedList.clear();
+	drawnList.clear();
+	for(unsigned int s = 0; s < NUM_STAGES; ++s) {
+		total.stages[s].clear();
+	}
+	addresses.clear();
+}
+
+//--------------------------------------------------------------
+string OscLatency::getStageName(Stage stage) {
+	switch(stage) {
+		case QUEUE: return "queue";
+		case DRAW:  return "draw";
+		case SWAP:  return "swap";
+		case TOTAL: return "total";
+		default:    return "unknown";
+	}
+}
@@ -0,0 +1,141 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+#include <unordered_map>
+
+/// a log scale histogram of latencies in microseconds, 4 buckets per power
+/// of 2 so percentiles are within about 20%
+class OscLatencyHistogram {
+
+	public:
+	
+		OscLatencyHistogram() {clear();}
+		
+		/// add a latency
+		void add(uint64_t us);
+		
+		/// get an approximate percentile, 0 - 1, returns 0 if empty
+		uint64_t getPercentile(float percentile) const;
+		
+		uint64_t getMax() const {return max;}
+		unsigned int getCount() const {return count;}
+		
+		void clear();
+		
+		static const unsigned int NUM_BUCKETS = 128;
+	
+	protected:
+	
+		/// get the bucket for a latency & the largest latency in a bucket
+		static unsigned int bucket(uint64_t us);
+		static uint64_t bucketMax(unsigned int index);
+	
+		unsigned int buckets[NUM_BUCKETS];
+		unsigned int count;
+		uint64_t max;
+};
+
+/// input to photon latency stats for received messages
+///
+/// each message is stamped when read from the socket, when dispatched, when
+/// the frame it was dispatched in is drawn, & after that frame's buffer swap,
+/// the times between are aggregated per address so it's possible to tell if
+/// time is spent in the queue, waiting for the draw, or waiting for the swap
+///
+/// the swap is stamped at the start of the next frame, which is after the
+/// buffer swap returns
+///
+/// note: main thread only
+class OscLatency {
+
+	public:
+	
+		/// the stages between stamps
+		enum Stage {
+			QUEUE, //< read -> dispatch
+			DRAW,  //< dispatch -> draw
+			SWAP,  //< draw -> swap
+			TOTAL, //< read -> swap
+			NUM_STAGES
+		};
+		
+		/// latencies for each stage
+		struct Stats {
+			OscLatencyHistogram stages[NUM_STAGES];
+		};
+	
+		OscLatency();
+		
+		/// enable stamping? clears pending stamps when disabled
+		void setEnabled(bool enabled);
+		bool isEnabled() {return bEnabled;}
+		
+		/// set the max number of addresses with their own stats,
+		/// messages to other addresses are only counted in the total
+		void setMaxAddresses(unsigned int max) {maxAddresses = max;}
+		unsigned int getMaxAddresses() {return maxAddresses;}
+		
+		/// stamp a message as dispatched, readTime is when it was received
+		void dispatched(const string &address, uint64_t readTime);
+		
+		/// stamp messages dispatched since the last draw, call after drawing
+		void drawn();
+		
+		/// stamp drawn messages & add them to the stats,
+		/// call at the start of the next frame
+		void swapped();
+		
+		/// stats for all messages
+		const Stats& getTotal() {return total;}
+		
+		/// stats by address
+		typedef unordered_map<string, Stats>::const_iterator const_iterator;
+		const_iterator begin() const {return addresses.begin();}
+		const_iterator end() const {return addresses.end();}
+		const Stats* getStats(const string &address) const;
+		
+		/// clear all stats & pending stamps
+		void clear();
+		
+		/// a stage name, ie. "queue"
+		static string getStageName(Stage stage);
+	
+	protected:
+	
+		/// a message waiting for its draw & swap stamps
+		struct Pending {
+			Stats *stats; //< NULL if the address has no stats of its own
+			uint64_t readTime;
+			uint64_t dispatchTime;
+		};
+		
+		bool bEnabled;
+		unsigned int maxAddresses;
+		vector<Pending> dispatchedList; //< dispatched since the last draw
+		vector<Pending> drawnList; //< drawn, waiting for the swap
+		uint64_t drawTime;
+		Stats total;
+		unordered_map<string, Stats> addresses; //< node based, so Stats pointers are stable
+};
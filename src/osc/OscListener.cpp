@@ -0,0 +1,123 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscListener.h"
+
+// default max number of packets queued between updates
+#define DEFAULT_QUEUE_SIZE 1024
+
+// max memory held by the queue slots for packets over OSC_MAX_PACKET_SIZE
+#define MAX_LARGE_BYTES (16*1024*1024)
+
+//--------------------------------------------------------------
+OscListener::OscListener() : queue(DEFAULT_QUEUE_SIZE),
+	maxPacketSize(OSC_MAX_PACKET_SIZE), largeBytes(0),
+	numReceived(0), numDropped(0), numSocketDropped(0) {}
+
+//--------------------------------------------------------------
+void OscListener::setSubtree(const string &subtree) {
+	this->subtree = subtree;
+	
+	// no trailing slash
+	while(!this->subtree.empty() && this->subtree[this->subtree.size()-1] == '/') {
+		this->subtree.erase(this->subtree.size()-1);
+	}
+}
+
+//--------------------------------------------------------------
+bool OscListener::isWithinSubtree(const string &address) {
+	if(subtree.empty()) {
+		return true;
+	}
+	return address.compare(0, subtree.size(), subtree) == 0 &&
+		(address.size() == subtree.size() || address[subtree.size()] == '/');
+}
+
+//--------------------------------------------------------------
+bool OscListener::setQueueSize(unsigned int size) {
+	if(isListening()) {
+		ofLogWarning() << "OscListener: can't set queue size while listening";
+		return false;
+	}
+	if(size == 0) {
+		ofLogWarning() << "OscListener: queue size must be > 0";
+		return false;
+	}
+	queue.setCapacity(size);
+	largeBytes = 0;
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscListener::resetCounters() {
+	numReceived = 0;
+	numDropped = 0;
+	numSocketDropped = 0;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+bool OscListener::canQueuePacket(unsigned int size) {
+	OscPacket *packet = queue.back();
+	if(packet == NULL) {
+		return false;
+	}
+	if(size <= OSC_MAX_PACKET_SIZE || size <= packet->large.capacity()) {
+		return true;
+	}
+	
+	// grows the slot buffer, free slots keep theirs so release them first
+	// if that's over the max, always allow one so a big packet can't stall
+	if(largeBytes + size - packet->large.capacity() > MAX_LARGE_BYTES) {
+		OscPacket *slot;
+		for(unsigned int i = 0; (slot = queue.back(i)) != NULL; ++i) {
+			largeBytes -= slot->large.capacity();
+			vector<char>().swap(slot->large);
+		}
+		if(largeBytes > 0 && largeBytes + size > MAX_LARGE_BYTES) {
+			return false; // wait for the receiver to release some
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscListener::queuePacket(const char *data, unsigned int size,
+                              const osc::IpEndpointName &endpoint) {
+	numReceived++;
+	
+	// never wait on the main thread
+	if(size > maxPacketSize || !canQueuePacket(size)) {
+		numDropped++;
+		return false;
+	}
+	OscPacket *packet = queue.back();
+	largeBytes -= packet->large.capacity();
+	packet->set(data, size);
+	largeBytes += packet->large.capacity();
+	packet->endpoint = endpoint;
+	packet->time = oscMonotonicTime();
+	
+	// hand off to main thread
+	queue.push();
+	return true;
+}
@@ -0,0 +1,103 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+#include "OscRingBuffer.h"
+
+/// base for a listening transport which queues raw packets for an OscReceiver
+///
+/// each listener has its own thread & queue so listeners never contend with
+/// each other, the receiver drains all of the queues on update
+///
+/// a listener can be bound to an address subtree, ie. "/visual/lights", in
+/// which case messages outside of it are ignored
+class OscListener {
+
+	public:
+	
+		OscListener();
+		virtual ~OscListener() {}
+		
+		/// start the listening thread, returns false if it can't be started
+		virtual bool start() = 0;
+		
+		/// stop the listening thread, does not clear the queue
+		virtual void stop() = 0;
+		
+		/// is the thread running?
+		virtual bool isListening() = 0;
+		
+		/// description for logging, ie. "udp 9990"
+		virtual string getName() = 0;
+		
+		/// should the receiver record packets from this listener? false for
+		/// listeners which replay recorded traffic so it isn't recorded twice
+		virtual bool isRecordable() {return true;}
+		
+		/// set the address subtree this listener is bound to, "" for all
+		void setSubtree(const string &subtree);
+		const string& getSubtree() {return subtree;}
+		
+		/// is an address within the subtree?
+		bool isWithinSubtree(const string &address);
+		
+		/// set the max number of packets queued between updates,
+		/// rounded up to the next power of 2, can't be set while listening
+		bool setQueueSize(unsigned int size);
+		unsigned int getQueueSize() {return queue.getCapacity();}
+		
+		/// set the max packet size in bytes, larger packets are dropped,
+		/// packets over OSC_MAX_PACKET_SIZE allocate when first received &
+		/// the queue holds at most 16 MB of them, see canQueuePacket()
+		void setMaxPacketSize(unsigned int size) {maxPacketSize = size;}
+		unsigned int getMaxPacketSize() {return maxPacketSize;}
+		
+		/// the packet queue, consumed by the receiver on the main thread
+		OscRingBuffer<OscPacket>& getQueue() {return queue;}
+		
+		/// packet counters
+		unsigned int getNumReceived() {return numReceived;}
+		unsigned int getNumDropped() {return numDropped;} //< queue full or too big
+		unsigned int getNumSocketDropped() {return numSocketDropped;} //< by the os, if known
+		void resetCounters();
+	
+	protected:
+	
+		/// can a packet of a given size be queued now? false if the queue is
+		/// full or the packets over OSC_MAX_PACKET_SIZE waiting in it hold the
+		/// max memory, frees the buffers of free slots if needed, call from the
+		/// listening thread
+		bool canQueuePacket(unsigned int size);
+	
+		/// copy a packet into the next free queue slot, call from the listening
+		/// thread, returns false & counts a drop if full or too big
+		bool queuePacket(const char *data, unsigned int size,
+		                 const osc::IpEndpointName &endpoint);
+	
+		OscRingBuffer<OscPacket> queue; //< listening thread -> main thread
+		unsigned int maxPacketSize;
+		string subtree; //< address subtree or "" for all
+		size_t largeBytes; //< large packet buffer capacity in the slots, listening thread only
+		std::atomic<unsigned int> numReceived, numDropped, numSocketDropped;
+};
@@ -0,0 +1,219 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscMessage.h"
+
+// osc data is big endian & padded to 4 bytes
+static inline unsigned int pad4(unsigned int size) {
+	return (size + 3) & ~((unsigned int) 3);
+}
+
+static inline uint32_t readUInt32(const char *p) {
+	const unsigned char *u = (const unsigned char *) p;
+	return ((uint32_t) u[0] << 24) | ((uint32_t) u[1] << 16) |
+	       ((uint32_t) u[2] << 8) | (uint32_t) u[3];
+}
+
+static inline uint64_t readUInt64(const char *p) {
+	return ((uint64_t) readUInt32(p) << 32) | (uint64_t) readUInt32(p+4);
+}
+
+//--------------------------------------------------------------
+OscMessage::OscMessage(const osc::ReceivedMessage &message, const string &address,
+                       const osc::IpEndpointName &endpoint) :
+	message(message), address(&address), endpoint(endpoint), numArgs(0) {
+	
+	const char *tags = message.TypeTags();
+	unsigned int count = message.ArgumentCount();
+	if(tags == NULL || count == 0) {
+		return;
+	}
+	
+	// args start after the padded ",tags" string, oscpack has already
+	// checked the arg sizes fit within the message
+	const char *arg = (tags - 1) + pad4(count + 2);
+	for(unsigned int i = 0; i < count && i < OSC_MESSAGE_MAX_ARGS; ++i) {
+		argTypes[i] = tags[i];
+		args[i] = arg;
+		switch(tags[i]) {
+			case osc::INT32_TYPE_TAG: case osc::FLOAT_TYPE_TAG:
+			case osc::CHAR_TYPE_TAG: case osc::RGBA_COLOR_TYPE_TAG:
+			case osc::MIDI_MESSAGE_TYPE_TAG:
+				arg += 4;
+				break;
+			case osc::INT64_TYPE_TAG: case osc::TIME_TAG_TYPE_TAG:
+			case osc::DOUBLE_TYPE_TAG:
+				arg += 8;
+				break;
+			case osc::STRING_TYPE_TAG: case osc::SYMBOL_TYPE_TAG:
+				arg += pad4(strlen(arg) + 1);
+				break;
+			case osc::BLOB_TYPE_TAG:
+				arg += 4 + pad4(readUInt32(arg));
+				break;
+			default: // no data: T, F, N, I, arrays
+				break;
+		}
+		numArgs++;
+	}
+}
+
+//--------------------------------------------------------------
+string OscMessage::getRemoteIp() const {
+	char host[osc::IpEndpointName::ADDRESS_STRING_LENGTH];
+	endpoint.AddressAsString(host);
+	return host;
+}
+
+//--------------------------------------------------------------
+ofxOscArgType OscMessage::getArgType(unsigned int index) const {
+	if(index >= numArgs) {
+		return OFXOSC_TYPE_INDEXOUTOFBOUNDS;
+	}
+	return (ofxOscArgType) argTypes[index];
+}
+
+//--------------------------------------------------------------
+int32_t OscMessage::getArgAsInt32(unsigned int index) const {
+	if(!checkArg(index, "ih", "an int32 or int64")) {
+		return 0;
+	}
+	if(argTypes[index] == osc::INT64_TYPE_TAG) {
+		return (int32_t) getArgAsInt64(index);
+	}
+	return (int32_t) readUInt32(args[index]);
+}
+
+//--------------------------------------------------------------
+int64_t OscMessage::getArgAsInt64(unsigned int index) const {
+	if(!checkArg(index, "ih", "an int32 or int64")) {
+		return 0;
+	}
+	if(argTypes[index] == osc::INT32_TYPE_TAG) {
+		return (int64_t) (int32_t) readUInt32(args[index]);
+	}
+	return (int64_t) readUInt64(args[index]);
+}
+
+//--------------------------------------------------------------
+float OscMessage::getArgAsFloat(unsigned int index) const {
+	if(!checkArg(index, "fd", "a float or double")) {
+		return 0;
+	}
+	if(argTypes[index] == osc::DOUBLE_TYPE_TAG) {
+		return (float) getArgAsDouble(index);
+	}
+	uint32_t u = readUInt32(args[index]);
+	float f;
+	memcpy(&f, &u, sizeof(float));
+	return f;
+}
+
+//--------------------------------------------------------------
+double OscMessage::getArgAsDouble(unsigned int index) const {
+	if(!checkArg(index, "fd", "a float or double")) {
+		return 0;
+	}
+	if(argTypes[index] == osc::FLOAT_TYPE_TAG) {
+		return (double) getArgAsFloat(index);
+	}
+	uint64_t u = readUInt64(args[index]);
+	double d;
+	memcpy(&d, &u, sizeof(double));
+	return d;
+}
+
+//--------------------------------------------------------------
+const char* OscMessage::getArgAsString(unsigned int index) const {
+	if(!checkArg(index, "sS", "a string or symbol")) {
+		return "";
+	}
+	return args[index];
+}
+
+//--------------------------------------------------------------
+const char* OscMessage::getArgAsBlob(unsigned int index, unsigned int &size) const {
+	if(!checkArg(index, "b", "a blob")) {
+		size = 0;
+		return NULL;
+	}
+	size = readUInt32(args[index]);
+	return args[index] + 4;
+}
+
+//--------------------------------------------------------------
+void OscMessage::copyTo(ofxOscMessage &dest) const {
+	dest.clear();
+	dest.setAddress(*address);
+	dest.setRemoteEndpoint(getRemoteIp(), endpoint.port);
+	for(osc::ReceivedMessage::const_iterator arg = message.ArgumentsBegin();
+		arg != message.ArgumentsEnd(); ++arg) {
+		if(arg->IsInt32()) {
+			dest.addIntArg(arg->AsInt32Unchecked());
+		}
+		else if(arg->IsInt64()) {
+			dest.addInt64Arg(arg->AsInt64Unchecked());
+		}
+		else if(arg->IsFloat()) {
+			dest.addFloatArg(arg->AsFloatUnchecked());
+		}
+		else if(arg->IsDouble()) {
+			dest.addDoubleArg(arg->AsDoubleUnchecked());
+		}
+		else if(arg->IsString()) {
+			dest.addStringArg(arg->AsStringUnchecked());
+		}
+		else if(arg->IsSymbol()) {
+			dest.addStringArg(arg->AsSymbolUnchecked());
+		}
+		else if(arg->IsBool()) {
+			dest.addBoolArg(arg->AsBoolUnchecked());
+		}
+		else if(arg->IsBlob()) {
+			const void *data;
+			osc::osc_bundle_element_size_t size;
+			arg->AsBlobUnchecked(data, size);
+			ofBuffer blob((const char *) data, size);
+			dest.addBlobArg(blob);
+		}
+		else {
+			ofLogError() << "OscMessage: argument in message "
+				<< *address << " is not an int, float, string, bool, or blob";
+		}
+	}
+}
+
+// PRIVATE
+//--------------------------------------------------------------
+bool OscMessage::checkArg(unsigned int index, const char *types, const char *name) const {
+	if(index >= numArgs) {
+		ofLogWarning() << "OscMessage: " << *address << " argument " << index
+			<< " out of range, " << numArgs << " argument(s)";
+		return false;
+	}
+	if(strchr(types, argTypes[index]) == NULL) {
+		ofLogWarning() << "OscMessage: " << *address << " argument " << index
+			<< " is not " << name;
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,91 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofxOsc.h"
+
+/// max number of arguments which can be read directly from an OscMessage,
+/// any remaining arguments are still passed on by copyTo()
+#define OSC_MESSAGE_MAX_ARGS 32
+
+/// a lightweight, non-owning view of a received osc message
+///
+/// reads the address & arguments directly from the packet buffer, so it is
+/// only valid while the packet it was created from is, use copyTo() to make
+/// an ofxOscMessage which can be kept
+///
+/// the arg getters follow ofxOscMessage, they convert between int32 & int64
+/// and float & double, an out of range index or other type logs a warning &
+/// returns 0, "", or an empty blob
+class OscMessage {
+
+	public:
+	
+		/// create a view of message, uses address as the message address
+		/// since it's usually a reused buffer on the receiving side
+		OscMessage(const osc::ReceivedMessage &message, const string &address,
+		           const osc::IpEndpointName &endpoint);
+		
+		/// create a view of the same message with a different address,
+		/// used when delivering a pattern to each matching object
+		OscMessage(const OscMessage &message, const string &address) :
+			OscMessage(message) {this->address = &address;}
+	
+		/// get the address
+		const string& getAddress() const {return *address;}
+		
+		/// get the sender
+		string getRemoteIp() const;
+		int getRemotePort() const {return endpoint.port;}
+		const osc::IpEndpointName& getEndpoint() const {return endpoint;}
+		
+		/// get the arguments
+		unsigned int getNumArgs() const {return numArgs;}
+		ofxOscArgType getArgType(unsigned int index) const;
+		int32_t getArgAsInt32(unsigned int index) const;
+		int64_t getArgAsInt64(unsigned int index) const;
+		float getArgAsFloat(unsigned int index) const;
+		double getArgAsDouble(unsigned int index) const;
+		const char* getArgAsString(unsigned int index) const; //< string or symbol
+		const char* getArgAsBlob(unsigned int index, unsigned int &size) const; //< data & size, NULL & 0 if not a blob
+		
+		/// copy into an ofxOscMessage,
+		/// unsupported arguments are skipped with an error
+		void copyTo(ofxOscMessage &dest) const;
+		
+		/// get the underlying oscpack message
+		const osc::ReceivedMessage& getReceivedMessage() const {return message;}
+	
+	private:
+	
+		/// is the arg at index one of the given type tags? warns if not
+		bool checkArg(unsigned int index, const char *types, const char *name) const;
+	
+		osc::ReceivedMessage message;
+		const string *address;
+		osc::IpEndpointName endpoint;
+	
+		unsigned int numArgs;
+		char argTypes[OSC_MESSAGE_MAX_ARGS]; //< type tag chars
+		const char *args[OSC_MESSAGE_MAX_ARGS]; //< pointers to arg data
+};
@@ -25,28 +25,61 @@
 #include "OscObject.h"
 
 //--------------------------------------------------------------
-bool OscObject::processOsc(const ofxOscMessage& message) {
-
-	// call any attached objects
-	vector<OscObject*>::iterator objectIter;
-	for(objectIter = _objectList.begin(); objectIter != _objectList.end();) {
-		
-		// try to process message
-		if((*objectIter) != NULL) {
-			if((*objectIter)->processOsc(message)) {
-				return true;
-			}
-			objectIter++; // increment iter
+bool OscObject::processOsc(const OscMessage& message) {
+
+	updateAddressMap();
+	if(!_objectList.empty() && OscPattern::isPattern(message.getAddress())) {
+		if(processOscPattern(message)) {
+			return true;
 		}
-		else {    // bad object, so erase it
-			objectIter = _objectList.erase(objectIter);
-			ofLogWarning() << "OscObject: removed NULL object";
+	}
+	
+	// call any attached objects whose root address matches,
+	// falling through to shorter roots if they don't handle it
+	else if(!_objectList.empty()) {
+		const string &address = message.getAddress();
+		const vector<OscObject*> *objects = _addressMap.find(address);
+		while(objects != NULL) {
+			for(unsigned int i = 0; i < objects->size(); ++i) {
+				if(objects->at(i)->processOsc(message)) {
+					return true;
+				}
+			}
+			objects = _addressMap.findParent(objects->front()->getOscRootAddress());
 		}
 	}
 
 	return processOscMessage(message);
 }
 
+//--------------------------------------------------------------
+bool OscObject::processOscPattern(const OscMessage& message) {
+	ofPtr<OscPattern> pattern = OscPattern::get(message.getAddress());
+	const string &patternAddress = pattern->getPattern();
+	
+	// one pass over the attached roots, an object may handle the remainder
+	// of the pattern itself so keep the rest unexpanded
+	bool handled = false;
+	string address;
+	OscAddressMap::const_iterator iter;
+	for(iter = _addressMap.begin(); iter != _addressMap.end(); ++iter) {
+		string::size_type end = pattern->matchRoot(iter->first);
+		if(end == string::npos) {
+			continue;
+		}
+		address = iter->first;
+		address.append(patternAddress, end, string::npos);
+		OscMessage m(message, address);
+		const vector<OscObject*> &objects = iter->second;
+		for(unsigned int i = 0; i < objects.size(); ++i) {
+			if(objects[i]->processOsc(m)) {
+				handled = true;
+			}
+		}
+	}
+	return handled;
+}
+
 //--------------------------------------------------------------
 void OscObject::addOscObject(OscObject* object) {
 	if(object == NULL) {
@@ -54,6 +87,8 @@ void OscObject::addOscObject(OscObject* object) {
 		return;
 	}
 	_objectList.push_back(object);
+	_addressMap.add(object);
+	object->_parent = this;
 }
 
 //--------------------------------------------------------------
@@ -68,27 +103,96 @@ void OscObject::removeOscObject(OscObject* object) {
 	iter = find(_objectList.begin(), _objectList.end(), object);
 	if(iter != _objectList.end()) {
 		_objectList.erase(iter);
+		_addressMap.remove(object);
+		object->_parent = NULL;
+		if(object->oscRootPath.getParent() == &oscRootPath) {
+			object->oscRootPath.detach(); // we may not outlive it
+		}
 	}
 }
 
+//--------------------------------------------------------------
+OscObject* OscObject::findOscObject(const string &address) {
+	updateAddressMap();
+	const vector<OscObject*> *objects = _addressMap.find(address);
+	if(objects != NULL) {
+		return objects->front()->findOscObject(address);
+	}
+	return this;
+}
+
 //--------------------------------------------------------------
 void OscObject::setOscRootAddress(string rootAddress) {
-	oscRootAddress = rootAddress;
+	if(oscRootPath.getParent() == NULL && rootAddress == oscRootPath.getAddress()) {
+		return;
+	}
+	string oldRootAddress = oscRootPath.getAddress();
+	oscRootPath.set(rootAddress);
+	
+	// move attached objects within the old root, those following our
+	// root path have already moved with it
+	for(unsigned int i = 0; i < _objectList.size(); ++i) {
+		OscObject *child = _objectList[i];
+		if(child->oscRootPath.getParent() == &oscRootPath) {
+			continue;
+		}
+		const string &childAddress = child->getOscRootAddress();
+		if(childAddress.compare(0, oldRootAddress.size(), oldRootAddress) == 0 &&
+		   (childAddress.size() == oldRootAddress.size() ||
+		    childAddress[oldRootAddress.size()] == '/')) {
+			child->setOscRootAddress(oscRootPath.getAddress() + childAddress.substr(oldRootAddress.size()));
+		}
+	}
+	
+	// reindex in parent
+	if(_parent != NULL) {
+		_parent->_addressMap.remove(this);
+		_parent->_addressMap.add(this);
+	}
 }
 
 //--------------------------------------------------------------
-string& OscObject::getOscRootAddress() {
-	return oscRootAddress;
+void OscObject::setOscRootAddress(OscObject *parent, const string &name) {
+	if(parent == NULL) {
+		ofLogWarning() << "OscObject: cannot follow NULL parent";
+		return;
+	}
+	oscRootPath.set(&parent->oscRootPath, name);
+	
+	// reindex in parent
+	if(_parent != NULL) {
+		_parent->_addressMap.remove(this);
+		_parent->_addressMap.add(this);
+	}
+}
+
+//--------------------------------------------------------------
+const string& OscObject::getOscRootAddress() {
+	return oscRootPath.getAddress();
+}
+
+//--------------------------------------------------------------
+bool OscObject::isOscAddress(const OscMessage &message, const char *relative) {
+	const string &root = oscRootPath.getAddress();
+	const string &address = message.getAddress();
+	return address.size() > root.size() &&
+	       address.compare(0, root.size(), root) == 0 &&
+	       address.compare(root.size(), string::npos, relative) == 0;
 }
 
 //--------------------------------------------------------------
 void OscObject::prependOscRootAddress(string prepend) {
-	oscRootAddress = prepend + oscRootAddress;
+	setOscRootAddress(prepend + oscRootPath.getAddress());
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryBool(const ofxOscMessage& message, bool &dest, unsigned int at) {
-	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
+bool OscObject::tryBool(const OscMessage &message, bool &dest, unsigned int at) {
+	if(message.getArgType(at) == OFXOSC_TYPE_TRUE ||
+	   message.getArgType(at) == OFXOSC_TYPE_FALSE) {
+		dest = (message.getArgType(at) == OFXOSC_TYPE_TRUE);
+		return true;
+	}
+	else if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (bool) message.getArgAsInt32(at);
 		return true;
@@ -101,7 +205,7 @@ bool OscObject::tryBool(const ofxOscMessage& message, bool &dest, unsigned int a
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryChar(const ofxOscMessage& message, char &dest, unsigned int at) {
+bool OscObject::tryChar(const OscMessage &message, char &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (char) message.getArgAsInt32(at);
@@ -111,7 +215,7 @@ bool OscObject::tryChar(const ofxOscMessage& message, char &dest, unsigned int a
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryNumber(const ofxOscMessage& message, int &dest, unsigned int at) {
+bool OscObject::tryNumber(const OscMessage &message, int &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (int) message.getArgAsInt32(at);
@@ -125,7 +229,7 @@ bool OscObject::tryNumber(const ofxOscMessage& message, int &dest, unsigned int
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryNumber(const ofxOscMessage& message, unsigned int &dest, unsigned int at) {
+bool OscObject::tryNumber(const OscMessage &message, unsigned int &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (unsigned int) message.getArgAsInt32(at);
@@ -139,7 +243,7 @@ bool OscObject::tryNumber(const ofxOscMessage& message, unsigned int &dest, unsi
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryNumber(const ofxOscMessage& message, float &dest, unsigned int at) {
+bool OscObject::tryNumber(const OscMessage &message, float &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (float) message.getArgAsInt32(at);
@@ -153,7 +257,7 @@ bool OscObject::tryNumber(const ofxOscMessage& message, float &dest, unsigned in
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryNumber(const ofxOscMessage& message, double &dest, unsigned int at) {
+bool OscObject::tryNumber(const OscMessage &message, double &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_INT32 ||
 	   message.getArgType(at) == OFXOSC_TYPE_INT64) {
 		dest = (double) message.getArgAsInt32(at);
@@ -167,10 +271,34 @@ bool OscObject::tryNumber(const ofxOscMessage& message, double &dest, unsigned i
 }
 
 //--------------------------------------------------------------
-bool OscObject::tryString(const ofxOscMessage& message, string &dest, unsigned int at) {
+bool OscObject::tryString(const OscMessage &message, string &dest, unsigned int at) {
 	if(message.getArgType(at) == OFXOSC_TYPE_STRING) {
 		dest = message.getArgAsString(at);
 		return true;
 	}
 	return false;
 }
+
+//--------------------------------------------------------------
+bool OscObject::tryBlob(const OscMessage &message, const char *&data,
+                        unsigned int &size, unsigned int at) {
+	if(message.getArgType(at) == OFXOSC_TYPE_BLOB) {
+		data = message.getArgAsBlob(at, size);
+		return true;
+	}
+	return false;
+}
+
+// PRIVATE
+//--------------------------------------------------------------
+void OscObject::updateAddressMap() {
+	unsigned long stamp = oscRootPath.getStamp();
+	if(stamp == _addressMapStamp) {
+		return;
+	}
+	_addressMap.clear();
+	for(unsigned int i = 0; i < _objectList.size(); ++i) {
+		_addressMap.add(_objectList[i]);
+	}
+	_addressMapStamp = stamp;
+}
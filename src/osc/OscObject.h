@@ -24,7 +24,10 @@
 ==============================================================================*/
 #pragma once
 
-#include "ofxOsc.h"
+#include "OscMessage.h"
+#include "OscAddressMap.h"
+#include "OscPattern.h"
+#include "OscPath.h"
 
 /// derive this class to add to an OscListener,
 /// set the processing function to match messages
@@ -32,42 +35,83 @@ class OscObject {
 
 	public:
 
-		OscObject(string rootAddress="") : oscRootAddress(rootAddress) {}
+		OscObject(string rootAddress="") : oscRootPath(rootAddress),
+			_addressMapStamp(0), _parent(NULL) {}
 
 		/// process attached objects, then call processOscMessage
 		/// returns true if message handled
-		bool processOsc(const ofxOscMessage& message);
+		///
+		/// attached objects are looked up by their root address, so they only
+		/// receive messages within it
+		///
+		/// pattern addresses, ie. "/visual/grid/cell*/color", are delivered to
+		/// every attached object whose root matches the leading segments with
+		/// the matched root filled in, ie. "/visual/grid/cell3/color"
+		bool processOsc(const OscMessage& message);
 
 		/// attach/remove an OscObject to this one
 		void addOscObject(OscObject *object);
 		void removeOscObject(OscObject *object);
 
-		/// get/set the root address of this object
+		/// find the attached object, or one attached to it, with the longest
+		/// root address matching the given address, returns this object if none
+		/// match, ie. "/visual/scene1/rect/position" -> "/visual/scene1/rect"
+		OscObject* findOscObject(const string &address);
+
+		/// get/set the root address of this object,
+		/// attached objects within the current root are moved to the new root
 		void setOscRootAddress(string rootAddress);
-		string& getOscRootAddress();
+		const string& getOscRootAddress();
 		void prependOscRootAddress(string prepend);
 		
+		/// set the root address to follow a parent object's root with a name,
+		/// ie. "/visual/scene1" + "rect", re-rooting the parent re-roots this
+		/// object & those following it without touching them
+		void setOscRootAddress(OscObject *parent, const string &name);
+		
+		/// is the message address this object's root + a relative address,
+		/// ie. "/visual/bitmap" + "/data", compares in place without
+		/// building the full address
+		bool isOscAddress(const OscMessage &message, const char *relative);
+		
+		/// get the root address as an interned path
+		OscPath& getOscRootPath() {return oscRootPath;}
+		
 		/// try to get an argument as a given type, fail silently
-		static bool tryBool(const ofxOscMessage &message, bool &dest, unsigned int at);
+		static bool tryBool(const OscMessage &message, bool &dest, unsigned int at);
 
-		static bool tryChar(const ofxOscMessage &message, char &dest, unsigned int at);
+		static bool tryChar(const OscMessage &message, char &dest, unsigned int at);
 		
-		static bool tryNumber(const ofxOscMessage &message, int &dest, unsigned int at);
-		static bool tryNumber(const ofxOscMessage &message, unsigned int &dest, unsigned int at);
-		static bool tryNumber(const ofxOscMessage &message, float &dest, unsigned int at);
-		static bool tryNumber(const ofxOscMessage &message, double &dest, unsigned int at);
+		static bool tryNumber(const OscMessage &message, int &dest, unsigned int at);
+		static bool tryNumber(const OscMessage &message, unsigned int &dest, unsigned int at);
+		static bool tryNumber(const OscMessage &message, float &dest, unsigned int at);
+		static bool tryNumber(const OscMessage &message, double &dest, unsigned int at);
 		
-		static bool tryString(const ofxOscMessage &message, string &dest, unsigned int at);
+		static bool tryString(const OscMessage &message, string &dest, unsigned int at);
+		
+		/// blob data points into the message, so is only valid while it is
+		static bool tryBlob(const OscMessage &message, const char *&data,
+		                    unsigned int &size, unsigned int at);
 
 	protected:
 
 		/// callback to implement, returns true if message handled
-		virtual bool processOscMessage(const ofxOscMessage& message) {return false;}
+		virtual bool processOscMessage(const OscMessage& message) {return false;}
 
 		/// the root address of this object, aka something like "/root/test1/string2"
-		string oscRootAddress;
+		OscPath oscRootPath;
 
 	private:
+	
+		/// deliver a pattern message to all matching attached objects
+		bool processOscPattern(const OscMessage& message);
+		
+		/// reindex the attached objects if our root moved since they were added,
+		/// as those following it have moved too
+		void updateAddressMap();
 
 		vector<OscObject*> _objectList;
+		OscAddressMap _addressMap; //< attached objects by root address
+		unsigned long _addressMapStamp; //< root path stamp the map was built at
+		OscObject *_parent; //< object this one is attached to, if any
 };
@@ -0,0 +1,86 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofxOsc.h"
+#include <chrono>
+
+/// max size of a received osc packet stored without allocating,
+/// listeners drop larger packets unless they allow them, ie. over tcp
+#define OSC_MAX_PACKET_SIZE 4096
+
+/// default max size of a packet over tcp & in replayed recordings, which
+/// can hold tcp packets
+#define OSC_MAX_STREAM_PACKET_SIZE (1024*1024)
+
+/// get a monotonic time in microseconds, only useful for intervals
+inline uint64_t oscMonotonicTime() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// a raw osc packet as received from the network, copied into preallocated
+/// storage so it can be queued without allocating
+struct OscPacket {
+	char data[OSC_MAX_PACKET_SIZE]; //< packet bytes
+	unsigned int size; //< number of bytes used
+	osc::IpEndpointName endpoint; //< sender
+	uint64_t time; //< when received, see oscMonotonicTime()
+	vector<char> large; //< used instead of data for larger packets, only grows here
+	OscPacket() : size(0), time(0) {}
+	
+	/// get the packet bytes
+	const char* getData() const {
+		return size > OSC_MAX_PACKET_SIZE ? &large[0] : data;
+	}
+	
+	/// copy packet bytes in
+	void set(const char *bytes, unsigned int size) {
+		if(size > OSC_MAX_PACKET_SIZE) {
+			if(large.size() < size) {
+				large.resize(size);
+			}
+			memcpy(&large[0], bytes, size);
+		}
+		else {
+			memcpy(data, bytes, size);
+		}
+		this->size = size;
+	}
+};
+
+/// bundle timetag meaning "apply now"
+#define OSC_TIMETAG_IMMEDIATE 1
+
+/// seconds between the NTP epoch (1900) & the unix epoch (1970)
+#define OSC_NTP_UNIX_OFFSET 2208988800ULL
+
+/// get the current time as an osc timetag:
+/// NTP seconds in the upper 32 bits & fractional seconds in the lower 32 bits
+inline uint64_t oscTimeTagNow() {
+	uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	uint64_t seconds = us / 1000000 + OSC_NTP_UNIX_OFFSET;
+	uint64_t fraction = ((us % 1000000) << 32) / 1000000;
+	return (seconds << 32) | fraction;
+}
@@ -0,0 +1,147 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscPath.h"
+
+// interned segments, ids index the names
+static unordered_map<string, unsigned int> s_symbolIds;
+static vector<string> s_symbolNames;
+
+// last path version handed out, always increases
+static unsigned long s_pathVersion = 0;
+
+//--------------------------------------------------------------
+unsigned int OscSymbols::intern(const string &segment) {
+	unordered_map<string, unsigned int>::iterator iter = s_symbolIds.find(segment);
+	if(iter != s_symbolIds.end()) {
+		return iter->second;
+	}
+	unsigned int id = s_symbolNames.size();
+	s_symbolNames.push_back(segment);
+	s_symbolIds[segment] = id;
+	return id;
+}
+
+//--------------------------------------------------------------
+int OscSymbols::find(const string &segment) {
+	unordered_map<string, unsigned int>::const_iterator iter = s_symbolIds.find(segment);
+	return (iter == s_symbolIds.end() ? -1 : (int) iter->second);
+}
+
+//--------------------------------------------------------------
+const string& OscSymbols::getName(unsigned int id) {
+	return s_symbolNames[id];
+}
+
+//--------------------------------------------------------------
+unsigned int OscSymbols::size() {
+	return s_symbolNames.size();
+}
+
+//--------------------------------------------------------------
+void OscPath::set(const string &address) {
+	parent = NULL;
+	split(address, segments);
+	version = ++s_pathVersion;
+}
+
+//--------------------------------------------------------------
+void OscPath::set(OscPath *parent, const string &relative) {
+	this->parent = parent;
+	split(relative, segments);
+	version = ++s_pathVersion;
+}
+
+//--------------------------------------------------------------
+void OscPath::detach() {
+	if(parent == NULL) {
+		return;
+	}
+	update();
+	segments = ids;
+	parent = NULL;
+	version = ++s_pathVersion;
+}
+
+//--------------------------------------------------------------
+const string& OscPath::getAddress() {
+	update();
+	return address;
+}
+
+//--------------------------------------------------------------
+const vector<unsigned int>& OscPath::getIds() {
+	update();
+	return ids;
+}
+
+//--------------------------------------------------------------
+unsigned long OscPath::getStamp() const {
+	// each change takes a new, larger version so the newest along the chain
+	// changes whenever any path in it does
+	unsigned long newest = version;
+	for(const OscPath *p = parent; p != NULL; p = p->parent) {
+		if(p->version > newest) {
+			newest = p->version;
+		}
+	}
+	return newest;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscPath::update() {
+	unsigned long now = getStamp();
+	if(now == stamp && now != 0) {
+		return;
+	}
+	if(parent != NULL) {
+		ids = parent->getIds();
+		address = parent->getAddress();
+	}
+	else {
+		ids.clear();
+		address.clear();
+	}
+	for(unsigned int i = 0; i < segments.size(); ++i) {
+		ids.push_back(segments[i]);
+		address += "/";
+		address += OscSymbols::getName(segments[i]);
+	}
+	stamp = now;
+}
+
+//--------------------------------------------------------------
+void OscPath::split(const string &address, vector<unsigned int> &dest) {
+	dest.clear();
+	string::size_type start = 0;
+	while(start < address.size()) {
+		string::size_type slash = address.find('/', start);
+		if(slash == string::npos) {
+			slash = address.size();
+		}
+		if(slash > start) { // skip empty segments
+			dest.push_back(OscSymbols::intern(address.substr(start, slash-start)));
+		}
+		start = slash+1;
+	}
+}
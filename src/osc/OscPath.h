@@ -0,0 +1,106 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include <unordered_map>
+
+/// global table of interned osc address segments, ie. "visual" or "scene1",
+/// each unique segment gets a small integer id which never changes
+///
+/// note: not thread safe, only call from the main thread
+class OscSymbols {
+
+	public:
+	
+		/// get the id for a segment, adds it if it's new
+		static unsigned int intern(const string &segment);
+		
+		/// get the id for a segment without adding it, returns -1 if not found
+		static int find(const string &segment);
+		
+		/// get the segment for an id
+		static const string& getName(unsigned int id);
+		
+		/// number of interned segments
+		static unsigned int size();
+};
+
+/// an osc root address as interned segment ids, either absolute or relative
+/// to a parent path, ie. an object "/rect" within a scene "/scene1" within the
+/// base "/visual" for "/visual/scene1/rect"
+///
+/// changing a path re-roots every path below it in O(1), the full address of
+/// each is rebuilt lazily the next time it's requested
+///
+/// note: parents must outlive the paths following them, detach() first
+class OscPath {
+
+	public:
+	
+		OscPath() : parent(NULL), version(0), stamp(0) {}
+		OscPath(const string &address) : parent(NULL), version(0), stamp(0) {set(address);}
+		
+		/// set an absolute address, stops following any parent
+		void set(const string &address);
+		
+		/// follow a parent path with a relative address, ie. "/scene1"
+		void set(OscPath *parent, const string &relative);
+		
+		/// stop following the parent, keeping the current full address
+		void detach();
+		
+		/// get the parent path, NULL if absolute
+		OscPath* getParent() const {return parent;}
+		
+		/// segment ids relative to the parent
+		const vector<unsigned int>& getSegments() const {return segments;}
+		
+		/// full address, ie. "/visual/scene1/rect"
+		const string& getAddress();
+		
+		/// full segment ids
+		const vector<unsigned int>& getIds();
+		
+		/// changes whenever this path or any path above it changes
+		unsigned long getStamp() const;
+		
+		/// same full address? compares segment ids
+		bool operator==(OscPath &path) {return getIds() == path.getIds();}
+		bool operator!=(OscPath &path) {return !(*this == path);}
+	
+	protected:
+	
+		/// rebuild the full address & ids if stale
+		void update();
+		
+		/// split an address into interned segment ids
+		static void split(const string &address, vector<unsigned int> &dest);
+	
+		OscPath *parent; //< path followed, NULL if absolute
+		vector<unsigned int> segments; //< relative to the parent
+		unsigned long version; //< set from a global counter on each change
+		unsigned long stamp; //< getStamp() the full address was built at
+		string address; //< cached full address
+		vector<unsigned int> ids; //< cached full segment ids
+};
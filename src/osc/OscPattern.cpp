@@ -0,0 +1,252 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscPattern.h"
+
+// max number of compiled patterns to cache before starting over
+#define PATTERN_CACHE_SIZE 256
+
+unordered_map<string, ofPtr<OscPattern> > OscPattern::cache;
+
+//--------------------------------------------------------------
+bool OscPattern::compile(const string &pattern) {
+	this->pattern = pattern;
+	segments.clear();
+	bValid = false;
+	if(pattern.empty() || pattern[0] != '/') {
+		ofLogWarning() << "OscPattern: \"" << pattern << "\" does not start with a /";
+		return false;
+	}
+	
+	// split into segments after each "/"
+	string::size_type pos = 1;
+	while(true) {
+		string::size_type slash = pattern.find('/', pos);
+		string::size_type end = (slash == string::npos ? pattern.size() : slash);
+		segments.push_back(Segment());
+		segments.back().end = end;
+		if(!compileSegment(pattern.substr(pos, end-pos), segments.back())) {
+			ofLogWarning() << "OscPattern: malformed pattern \"" << pattern << "\"";
+			segments.clear();
+			return false;
+		}
+		if(slash == string::npos) {
+			break;
+		}
+		pos = slash+1;
+	}
+	bValid = true;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscPattern::matches(const string &address) const {
+	string::size_type end = matchRoot(address);
+	return end != string::npos && end == pattern.size();
+}
+
+//--------------------------------------------------------------
+string::size_type OscPattern::matchRoot(const string &rootAddress) const {
+	if(!bValid || rootAddress.empty() || rootAddress[0] != '/') {
+		return string::npos;
+	}
+	const char *begin = rootAddress.c_str()+1;
+	const char *end = rootAddress.c_str()+rootAddress.size();
+	for(unsigned int i = 0; i < segments.size(); ++i) {
+		const char *slash = begin;
+		while(slash != end && *slash != '/') {
+			slash++;
+		}
+		if(!matchSegment(segments[i], 0, begin, slash)) {
+			return string::npos;
+		}
+		if(slash == end) {
+			return segments[i].end;
+		}
+		begin = slash+1;
+	}
+	return string::npos; // root is longer than the pattern
+}
+
+//--------------------------------------------------------------
+bool OscPattern::isPattern(const string &address) {
+	return address.find_first_of("*?[{") != string::npos;
+}
+
+//--------------------------------------------------------------
+ofPtr<OscPattern> OscPattern::get(const string &pattern) {
+	unordered_map<string, ofPtr<OscPattern> >::iterator iter = cache.find(pattern);
+	if(iter != cache.end()) {
+		return iter->second;
+	}
+	if(cache.size() >= PATTERN_CACHE_SIZE) {
+		cache.clear();
+	}
+	ofPtr<OscPattern> compiled(new OscPattern(pattern));
+	cache[pattern] = compiled;
+	return compiled;
+}
+
+//--------------------------------------------------------------
+void OscPattern::clearCache() {
+	cache.clear();
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+bool OscPattern::compileSegment(const string &text, Segment &segment) {
+	string::size_type i = 0;
+	while(i < text.size()) {
+		switch(text[i]) {
+			case '?':
+				segment.tokens.push_back(Token(Token::ANY_CHAR));
+				i++;
+				break;
+			case '*':
+				// collapse runs of *
+				if(segment.tokens.empty() || segment.tokens.back().type != Token::ANY_RUN) {
+					segment.tokens.push_back(Token(Token::ANY_RUN));
+				}
+				i++;
+				break;
+			case '[': {
+				string::size_type close = text.find(']', i+1);
+				if(close == string::npos) {
+					return false;
+				}
+				Token token(Token::CHAR_SET);
+				string::size_type c = i+1;
+				if(c < close && text[c] == '!') {
+					token.bNegate = true;
+					c++;
+				}
+				for(; c < close; ++c) {
+					if(c+2 < close && text[c+1] == '-') { // range
+						token.text += text[c];
+						token.text += text[c+2];
+						c += 2;
+					}
+					else {
+						token.text += text[c];
+						token.text += text[c];
+					}
+				}
+				segment.tokens.push_back(token);
+				i = close+1;
+				break;
+			}
+			case '{': {
+				string::size_type close = text.find('}', i+1);
+				if(close == string::npos) {
+					return false;
+				}
+				Token token(Token::ALTERNATIVES);
+				string::size_type start = i+1;
+				while(true) {
+					string::size_type comma = text.find(',', start);
+					if(comma == string::npos || comma > close) {
+						token.alternatives.push_back(text.substr(start, close-start));
+						break;
+					}
+					token.alternatives.push_back(text.substr(start, comma-start));
+					start = comma+1;
+				}
+				segment.tokens.push_back(token);
+				i = close+1;
+				break;
+			}
+			case ']': case '}':
+				return false;
+			default: {
+				string::size_type next = text.find_first_of("?*[]{}", i);
+				if(next == string::npos) {
+					next = text.size();
+				}
+				Token token(Token::LITERAL);
+				token.text = text.substr(i, next-i);
+				segment.tokens.push_back(token);
+				i = next;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscPattern::matchSegment(const Segment &segment, unsigned int token,
+                              const char *begin, const char *end) const {
+	if(token == segment.tokens.size()) {
+		return begin == end;
+	}
+	const Token &t = segment.tokens[token];
+	switch(t.type) {
+		case Token::LITERAL:
+			if((unsigned int)(end-begin) < t.text.size() ||
+			   t.text.compare(0, t.text.size(), begin, t.text.size()) != 0) {
+				return false;
+			}
+			return matchSegment(segment, token+1, begin+t.text.size(), end);
+		case Token::ANY_CHAR:
+			if(begin == end) {
+				return false;
+			}
+			return matchSegment(segment, token+1, begin+1, end);
+		case Token::ANY_RUN:
+			if(token+1 == segment.tokens.size()) {
+				return true; // trailing * matches the rest
+			}
+			for(const char *c = begin; c <= end; ++c) {
+				if(matchSegment(segment, token+1, c, end)) {
+					return true;
+				}
+			}
+			return false;
+		case Token::CHAR_SET: {
+			if(begin == end) {
+				return false;
+			}
+			bool found = false;
+			for(unsigned int i = 0; i+1 < t.text.size(); i += 2) {
+				if(*begin >= t.text[i] && *begin <= t.text[i+1]) {
+					found = true;
+					break;
+				}
+			}
+			if(found == t.bNegate) {
+				return false;
+			}
+			return matchSegment(segment, token+1, begin+1, end);
+		}
+		case Token::ALTERNATIVES:
+			for(unsigned int i = 0; i < t.alternatives.size(); ++i) {
+				const string &alt = t.alternatives[i];
+				if((unsigned int)(end-begin) >= alt.size() &&
+				   alt.compare(0, alt.size(), begin, alt.size()) == 0 &&
+				   matchSegment(segment, token+1, begin+alt.size(), end)) {
+					return true;
+				}
+			}
+			return false;
+	}
+	return false;
+}
@@ -0,0 +1,102 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "ofMain.h"
+#include <unordered_map>
+
+/// a compiled OSC 1.0 address pattern, ie. "/visual/grid/cell*/color"
+///
+/// supports "?", "*", "[abc]", "[a-z]", "[!abc]" & "{foo,bar}" within address
+/// segments, wildcards never match across a "/"
+class OscPattern {
+
+	public:
+	
+		OscPattern() : bValid(false) {}
+		OscPattern(const string &pattern) : bValid(false) {compile(pattern);}
+	
+		/// compile a pattern, returns false & matches nothing if malformed
+		bool compile(const string &pattern);
+		
+		/// get the pattern string
+		const string& getPattern() const {return pattern;}
+		
+		/// does the whole address match?
+		bool matches(const string &address) const;
+		
+		/// does a root address match the leading segments of the pattern?
+		///
+		/// returns the position in the pattern string after the matched segments,
+		/// ie. 18 for "/visual/grid/cell3" & "/visual/grid/cell*/color" so the
+		/// remaining "/color" can be appended to the root, or string::npos
+		string::size_type matchRoot(const string &rootAddress) const;
+		
+		/// does an address contain any pattern characters?
+		static bool isPattern(const string &address);
+		
+		/// get a compiled pattern from the cache, compiles & adds it if needed,
+		/// hold on to the pointer while using it as the cache may be cleared
+		///
+		/// note: not thread safe, only call from the main thread
+		static ofPtr<OscPattern> get(const string &pattern);
+		
+		/// clear the compiled pattern cache
+		static void clearCache();
+	
+	protected:
+	
+		struct Token {
+			enum Type {
+				LITERAL,      //< exact text
+				ANY_CHAR,     //< ?
+				ANY_RUN,      //< *
+				CHAR_SET,     //< [...], text holds lo,hi char pairs
+				ALTERNATIVES  //< {...}
+			};
+			Token(Type type) : type(type), bNegate(false) {}
+			Type type;
+			string text;
+			bool bNegate; //< [!...]
+			vector<string> alternatives;
+		};
+		
+		/// an address segment between "/"s
+		struct Segment {
+			vector<Token> tokens;
+			string::size_type end; //< position in the pattern after this segment
+		};
+		
+		/// compile a single segment, returns false if malformed
+		bool compileSegment(const string &text, Segment &segment);
+		
+		/// match tokens from a given token index against a char range
+		bool matchSegment(const Segment &segment, unsigned int token,
+		                  const char *begin, const char *end) const;
+	
+		string pattern;
+		vector<Segment> segments;
+		bool bValid;
+	
+		static unordered_map<string, ofPtr<OscPattern> > cache; //< pattern -> compiled
+};
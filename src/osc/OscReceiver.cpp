@@ -24,16 +24,28 @@
 ==============================================================================*/
 #include "OscReceiver.h"
 
+#define DEFAULT_QUEUE_SIZE 1024
+
 //--------------------------------------------------------------
 OscReceiver::OscReceiver() :
-	m_bIsRunning(false), m_bIgnoreMessages(false) {
-	m_receiver = ofPtr<Receiver>();
+	m_queueSize(DEFAULT_QUEUE_SIZE), m_receiveBufferSize(0),
+	m_bIsRunning(false), m_bIgnoreMessages(false),
+	m_numDropped(0), m_numDroppedReported(0),
+	m_maxScheduled(DEFAULT_QUEUE_SIZE), m_presentationDelay(0), m_scheduledOrder(0),
+	m_bCoalesce(false), m_numCoalesced(0), m_bBacklogCollected(false) {
+	m_udpListener = ofPtr<OscUdpListener>(new OscUdpListener);
+	m_listeners.push_back(m_udpListener);
 }
 
 //--------------------------------------------------------------
 OscReceiver::OscReceiver(unsigned int port) :
-	m_bIsRunning(false), m_bIgnoreMessages(false) {
-	m_receiver = ofPtr<Receiver>();
+	m_queueSize(DEFAULT_QUEUE_SIZE), m_receiveBufferSize(0),
+	m_bIsRunning(false), m_bIgnoreMessages(false),
+	m_numDropped(0), m_numDroppedReported(0),
+	m_maxScheduled(DEFAULT_QUEUE_SIZE), m_presentationDelay(0), m_scheduledOrder(0),
+	m_bCoalesce(false), m_numCoalesced(0), m_bBacklogCollected(false) {
+	m_udpListener = ofPtr<OscUdpListener>(new OscUdpListener);
+	m_listeners.push_back(m_udpListener);
 	setup(port);
 }
 
@@ -45,51 +57,153 @@ OscReceiver::~OscReceiver() {
 
 //--------------------------------------------------------------
 bool OscReceiver::setup(unsigned int port) {
-	if(m_receiver.get() != NULL) {
-		ofLogWarning() << "OscReceiver: can't set port while thread is running";
-		return false;
-	}
-	m_port = port;
-	return true;
+	return m_udpListener->setPort(port);
 }
 
 //--------------------------------------------------------------
 void OscReceiver::start() {
-	if(m_receiver.get() != NULL) {
-		ofLogWarning() << "OscReceiver: can't start thread, already created";
+	if(m_bIsRunning) {
+		ofLogWarning() << "OscReceiver: can't start, already running";
 		return;
 	}
-
-	m_receiver = ofPtr<Receiver>(new Receiver);
-	if(m_receiver.get() == NULL) {
-		ofLogWarning() << "OscReceiver: could not create thread";
-		return false;
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		if(!m_listeners[i]->start()) {
+			ofLogWarning() << "OscReceiver: couldn't start "
+				<< m_listeners[i]->getName() << " listener";
+		}
 	}
-	m_receiver->receiver = this;
-	m_receiver->setup(m_port);
-	
 	m_bIsRunning = true;
 }
 
 //--------------------------------------------------------------
 void OscReceiver::stop() {
-	if(m_receiver.get() == NULL) {
+	if(!m_bIsRunning) {
 		return;
 	}
-	m_receiver.reset();
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		m_listeners[i]->stop(); // joins the listening thread
+		m_listeners[i]->getQueue().clear();
+	}
+	m_scheduled = priority_queue<ScheduledPacket, vector<ScheduledPacket>,
+	                             std::greater<ScheduledPacket> >();
+	m_backlog.clear();
 	m_bIsRunning = false;
 	m_bIgnoreMessages = false;
 }
 
+//--------------------------------------------------------------
+void OscReceiver::update() {
+
+	m_messages.clear();
+	
+	// when this frame is shown, bundles due by then are applied now
+	uint64_t now = oscTimeTagNow() + m_presentationDelay;
+	
+	// messages held while ignoring go first
+	m_bBacklogCollected = false;
+	if(!m_bIgnoreMessages && !m_backlog.empty()) {
+		collectBacklog();
+	}
+	
+	// scheduled bundles which are now due, these arrived before anything
+	// still in the queues
+	while(!m_scheduled.empty() && m_scheduled.top().timeTag <= now) {
+		const ScheduledPacket &scheduled = m_scheduled.top();
+		m_due.push_back(scheduled.packet);
+		collectPacket(*scheduled.packet, scheduled.listener.get());
+		m_scheduled.pop();
+	}
+	
+	// only process what's been received so far, anything arriving
+	// while processing waits until the next update
+	m_counts.resize(m_listeners.size());
+	for(unsigned int l = 0; l < m_listeners.size(); ++l) {
+		OscRingBuffer<OscPacket> &queue = m_listeners[l]->getQueue();
+		bool record = m_recorder.isOpen() && m_listeners[l]->isRecordable();
+		m_counts[l] = queue.size();
+		for(unsigned int i = 0; i < m_counts[l]; ++i) {
+			const OscPacket &packet = *queue.at(i);
+			if(record) {
+				m_recorder.record(packet);
+			}
+			
+			// hold bundles with a future timetag
+			if(packet.size >= 16 && memcmp(packet.getData(), "#bundle", 8) == 0) {
+				uint64_t timeTag = 0;
+				for(unsigned int b = 8; b < 16; ++b) {
+					timeTag = (timeTag << 8) | (unsigned char) packet.getData()[b];
+				}
+				if(timeTag != OSC_TIMETAG_IMMEDIATE && timeTag > now) {
+					if(!schedulePacket(packet, timeTag, m_listeners[l])) {
+						m_numDropped++;
+					}
+					continue;
+				}
+			}
+			collectPacket(packet, m_listeners[l].get());
+		}
+	}
+	if(m_bCoalesce) {
+		coalesce();
+	}
+	for(unsigned int i = 0; i < m_messages.size(); ++i) {
+		QueuedMessage &m = m_messages[i];
+		if(m_bIgnoreMessages) {
+			if(m_backlog.isEnabled() && !m.bSkip) {
+				m_backlog.add(m.data, m.size, m_addresses[i], m.endpoint, m.time,
+				              isTrigger(m_addresses[i]));
+			}
+			continue;
+		}
+		if(!m.bSkip) {
+			if(m_latency.isEnabled()) {
+				m_latency.dispatched(m_addresses[i], m.time);
+			}
+			OscMessage message(m.message, m_addresses[i], m.endpoint);
+			if(m_stats.isEnabled() && !m_bIgnoreMessages) {
+				uint64_t start = oscMonotonicTime();
+				bool handled = processMessage(message);
+				m_stats.add(m_addresses[i], handled, oscMonotonicTime() - start);
+			}
+			else {
+				processMessage(message);
+			}
+		}
+	}
+	for(unsigned int l = 0; l < m_listeners.size(); ++l) {
+		m_listeners[l]->getQueue().pop(m_counts[l]);
+	}
+	
+	// the views into the applied backlog are done with
+	if(m_bBacklogCollected) {
+		if(m_backlog.getNumDropped() > 0) {
+			ofLogWarning() << "OscReceiver: backlog dropped "
+				<< m_backlog.getNumDropped() << " message(s)";
+		}
+		m_backlog.clear();
+	}
+	
+	// the views into applied scheduled packets are done with
+	for(unsigned int i = 0; i < m_due.size(); ++i) {
+		m_packetPool.push_back(m_due[i]);
+	}
+	m_due.clear();
+	
+	unsigned int dropped = getNumDropped();
+	if(dropped != m_numDroppedReported) {
+		ofLogWarning() << "OscReceiver: dropped "
+			<< dropped - m_numDroppedReported << " packet(s)";
+		m_numDroppedReported = dropped;
+	}
+}
+
 //--------------------------------------------------------------
 void OscReceiver::addOscObject(OscObject *object) {
 	if(object == NULL) {
 		ofLogWarning() << "OscReceiver: can't add NULL object" << std::endl;
 		return;
 	}
-	mutex.lock();
 	_objectList.push_back(object);
-	mutex.unlock();
 }
 
 //--------------------------------------------------------------
@@ -100,18 +214,100 @@ void OscReceiver::removeOscObject(OscObject *object) {
 	}
 
 	// find object in list and remove it
-	mutex.lock();
 	vector<OscObject*>::iterator iter;
 	iter = find(_objectList.begin(), _objectList.end(), object);
 	if(iter != _objectList.end()) {
 		_objectList.erase(iter);
 	}
-	mutex.unlock();
 }
 
 //--------------------------------------------------------------
 unsigned int OscReceiver::getPort() {
-	return m_port;
+	return m_udpListener->getPort();
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::addListener(ofPtr<OscListener> listener) {
+	if(listener.get() == NULL) {
+		ofLogWarning() << "OscReceiver: can't add NULL listener";
+		return false;
+	}
+	if(find(m_listeners.begin(), m_listeners.end(), listener) != m_listeners.end()) {
+		ofLogWarning() << "OscReceiver: " << listener->getName() << " listener already added";
+		return false;
+	}
+	if(m_bIsRunning && !listener->isListening() && !listener->start()) {
+		ofLogWarning() << "OscReceiver: couldn't start "
+			<< listener->getName() << " listener";
+		return false;
+	}
+	m_listeners.push_back(listener);
+	return true;
+}
+
+//--------------------------------------------------------------
+ofPtr<OscUdpListener> OscReceiver::addUdpListener(unsigned int port, const string &subtree) {
+	ofPtr<OscUdpListener> listener(new OscUdpListener(port, subtree));
+	listener->setQueueSize(m_queueSize);
+	listener->setBufferSize(m_receiveBufferSize);
+	if(!addListener(listener)) {
+		return ofPtr<OscUdpListener>();
+	}
+	return listener;
+}
+
+//--------------------------------------------------------------
+ofPtr<OscTcpListener> OscReceiver::addTcpListener(unsigned int port, const string &subtree) {
+	ofPtr<OscTcpListener> listener(new OscTcpListener(port, subtree));
+	listener->setQueueSize(m_queueSize);
+	if(!addListener(listener)) {
+		return ofPtr<OscTcpListener>();
+	}
+	return listener;
+}
+
+//--------------------------------------------------------------
+ofPtr<OscShmListener> OscReceiver::addShmListener(const string &name, unsigned int size,
+                                                  const string &subtree) {
+	ofPtr<OscShmListener> listener(new OscShmListener(name, size, subtree));
+	listener->setQueueSize(m_queueSize);
+	if(!addListener(listener)) {
+		return ofPtr<OscShmListener>();
+	}
+	return listener;
+}
+
+//--------------------------------------------------------------
+ofPtr<OscReplayListener> OscReceiver::addReplayListener(const string &path, bool fast) {
+	ofPtr<OscReplayListener> listener(new OscReplayListener(path, fast));
+	listener->setQueueSize(m_queueSize);
+	if(!addListener(listener)) {
+		return ofPtr<OscReplayListener>();
+	}
+	return listener;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::removeListener(ofPtr<OscListener> listener) {
+	if(listener == m_udpListener) {
+		ofLogWarning() << "OscReceiver: can't remove the default listener";
+		return;
+	}
+	vector<ofPtr<OscListener> >::iterator iter;
+	iter = find(m_listeners.begin(), m_listeners.end(), listener);
+	if(iter != m_listeners.end()) {
+		(*iter)->stop();
+		(*iter)->getQueue().clear();
+		m_listeners.erase(iter);
+	}
+}
+
+//--------------------------------------------------------------
+ofPtr<OscListener> OscReceiver::getListener(unsigned int index) {
+	if(index >= m_listeners.size()) {
+		return ofPtr<OscListener>();
+	}
+	return m_listeners[index];
 }
 
 //--------------------------------------------------------------
@@ -120,10 +316,224 @@ void OscReceiver::ignoreMessages(bool yesno) {
 }
 
 //--------------------------------------------------------------
-void OscReceiver::processMessage(const ofxOscMessage &message) {
+bool OscReceiver::setQueueSize(unsigned int size) {
+	if(m_bIsRunning) {
+		ofLogWarning() << "OscReceiver: can't set queue size while running";
+		return false;
+	}
+	if(size == 0) {
+		ofLogWarning() << "OscReceiver: queue size must be > 0";
+		return false;
+	}
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		m_listeners[i]->setQueueSize(size);
+	}
+	m_queueSize = size;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::setReceiveBufferSize(unsigned int size) {
+	if(m_bIsRunning) {
+		ofLogWarning() << "OscReceiver: can't set receive buffer size while running";
+		return false;
+	}
+	m_udpListener->setBufferSize(size);
+	m_receiveBufferSize = size;
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::addTrigger(const string &address) {
+	m_triggers.insert(address);
+}
+
+//--------------------------------------------------------------
+void OscReceiver::removeTrigger(const string &address) {
+	m_triggers.erase(address);
+}
+
+//--------------------------------------------------------------
+void OscReceiver::clearTriggers() {
+	m_triggers.clear();
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::isTrigger(const string &address) {
+	return m_triggers.find(address) != m_triggers.end();
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::startRecording(const string &path) {
+	return m_recorder.open(path);
+}
+
+//--------------------------------------------------------------
+unsigned int OscReceiver::getNumReceived() {
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		count += m_listeners[i]->getNumReceived();
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+unsigned int OscReceiver::getNumDropped() {
+	unsigned int count = m_numDropped;
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		count += m_listeners[i]->getNumDropped();
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::setPresentationDelay(double seconds) {
+	if(seconds < 0) {
+		seconds = 0;
+	}
+	m_presentationDelay = (uint64_t)(seconds * 4294967296.0); // 32 bit fraction
+}
+
+//--------------------------------------------------------------
+unsigned int OscReceiver::getNumSocketDropped() {
+	unsigned int count = 0;
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		count += m_listeners[i]->getNumSocketDropped();
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::resetCounters() {
+	for(unsigned int i = 0; i < m_listeners.size(); ++i) {
+		m_listeners[i]->resetCounters();
+	}
+	m_numDropped = 0;
+	m_numDroppedReported = 0;
+	m_numCoalesced = 0;
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::schedulePacket(const OscPacket &packet, uint64_t timeTag,
+                                 ofPtr<OscListener> listener) {
+	if(m_scheduled.size() >= m_maxScheduled) {
+		return false;
+	}
+	ofPtr<OscPacket> copy;
+	if(m_packetPool.empty()) {
+		copy = ofPtr<OscPacket>(new OscPacket);
+	}
+	else {
+		copy = m_packetPool.back();
+		m_packetPool.pop_back();
+	}
+	copy->set(packet.getData(), packet.size);
+	copy->endpoint = packet.endpoint;
+	copy->time = packet.time;
+	m_scheduled.push(ScheduledPacket(timeTag, m_scheduledOrder++, copy, listener));
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::collectPacket(const OscPacket &packet, OscListener *listener) {
+	try {
+		osc::ReceivedPacket p(packet.getData(), (int) packet.size);
+		if(p.IsBundle()) {
+			collectBundle(osc::ReceivedBundle(p), packet, listener);
+		}
+		else {
+			collectMessage(packet.getData(), packet.size, packet, listener);
+		}
+	}
+	catch(osc::Exception &e) {
+		ofLogError() << "OscReceiver: malformed packet: " << e.what();
+	}
+}
+
+//--------------------------------------------------------------
+void OscReceiver::collectBundle(const osc::ReceivedBundle &bundle,
+                                const OscPacket &packet, OscListener *listener) {
+	for(osc::ReceivedBundle::const_iterator element = bundle.ElementsBegin();
+		element != bundle.ElementsEnd(); ++element) {
+		if(element->IsBundle()) {
+			collectBundle(osc::ReceivedBundle(*element), packet, listener);
+		}
+		else {
+			collectMessage(element->Contents(), element->Size(), packet, listener);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void OscReceiver::collectMessage(const char *data, unsigned int size,
+                                 const OscPacket &packet, OscListener *listener) {
+	QueuedMessage message(data, size, packet.endpoint, packet.time);
+	unsigned int index = m_messages.size();
+	if(index >= m_addresses.size()) {
+		m_addresses.resize(index+1);
+	}
+	m_addresses[index] = message.message.AddressPattern(); // reuses capacity
+	if(listener != NULL && !listener->isWithinSubtree(m_addresses[index])) {
+		return;
+	}
+	m_messages.push_back(message);
+}
+
+//--------------------------------------------------------------
+void OscReceiver::collectBacklog() {
+	m_backlog.getEntries(m_backlogEntries);
+	for(unsigned int i = 0; i < m_backlogEntries.size(); ++i) {
+		const OscBacklog::Entry &entry = *m_backlogEntries[i];
+		try {
+			QueuedMessage message(&entry.data[0], entry.size, entry.endpoint, entry.time);
+			unsigned int index = m_messages.size();
+			if(index >= m_addresses.size()) {
+				m_addresses.resize(index+1);
+			}
+			m_addresses[index] = entry.address;
+			m_messages.push_back(message);
+		}
+		catch(osc::Exception &e) {
+			ofLogError() << "OscReceiver: malformed backlog message: " << e.what();
+		}
+	}
+	ofLogVerbose() << "OscReceiver: applying " << m_backlogEntries.size()
+		<< " backlog message(s)";
+	m_bBacklogCollected = true;
+}
+
+//--------------------------------------------------------------
+void OscReceiver::coalesce() {
+	if(m_messages.size() < 2) {
+		return;
+	}
+	
+	// sort message indices by address, keeping arrival order within an address
+	m_order.resize(m_messages.size());
+	for(unsigned int i = 0; i < m_order.size(); ++i) {
+		m_order[i] = i;
+	}
+	const vector<string> &addresses = m_addresses;
+	sort(m_order.begin(), m_order.end(), [&addresses](unsigned int a, unsigned int b) {
+		int cmp = addresses[a].compare(addresses[b]);
+		return cmp < 0 || (cmp == 0 && a < b);
+	});
+	
+	// skip all but the last of each run of the same address
+	for(unsigned int i = 0; i+1 < m_order.size(); ++i) {
+		const string &address = addresses[m_order[i]];
+		if(address == addresses[m_order[i+1]] && !isTrigger(address)) {
+			m_messages[m_order[i]].bSkip = true;
+			m_numCoalesced++;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+bool OscReceiver::processMessage(const OscMessage &message) {
 	
 	// ignore any incoming messages?
-	if(m_bIgnoreMessages) return;
+	if(m_bIgnoreMessages) return false;
 	
 	// call any attached objects
 	vector<OscObject*>::iterator iter;
@@ -141,46 +551,5 @@ void OscReceiver::processMessage(const ofxOscMessage &message) {
 			ofLogWarning() << "OscReceiver: removed NULL object";
 		}
 	}
-}
-
-//--------------------------------------------------------------
-void OscReceiver::Receiver::ProcessMessage(const osc::ReceivedMessage &m,
-										   const osc::IpEndpointName& remoteEndpoint) {
-	
-	// convert the message to an ofxOscMessage
-	ofxOscMessage message;
-
-	// set the address
-	message.setAddress(m.AddressPattern());
-
-	// set the sender ip/host
-	char endpoint_host[osc::IpEndpointName::ADDRESS_STRING_LENGTH];
-	remoteEndpoint.AddressAsString(endpoint_host);
-    message.setRemoteEndpoint(endpoint_host, remoteEndpoint.port);
-
-	// transfer the arguments
-	for(osc::ReceivedMessage::const_iterator arg = m.ArgumentsBegin();
-		arg != m.ArgumentsEnd(); ++arg) {
-		if(arg->IsInt32()) {
-			message.addIntArg(arg->AsInt32Unchecked());
-		}
-		else if(arg->IsInt64()) {
-			message.addInt64Arg(arg->AsInt64Unchecked());
-		}
-		else if(arg->IsFloat()) {
-			message.addFloatArg(arg->AsFloatUnchecked());
-		}
-		else if(arg->IsString()) {
-			message.addStringArg(arg->AsStringUnchecked());
-		}
-		else {
-			ofLogError() << "OscReceiver: argument in message "
-				<< m.AddressPattern() << " is not an int, float, or string";
-		}
-	}
-	
-	// send
-	receiver->mutex.lock();
-	receiver->processMessage(message);
-	receiver->mutex.unlock();
+	return false;
 }
@@ -25,8 +25,43 @@
 #pragma once
 
 #include "OscObject.h"
+#include "OscPacket.h"
+#include "OscUdpListener.h"
+#include "OscTcpListener.h"
+#include "OscShmListener.h"
+#include "OscReplayListener.h"
+#include "OscRecorder.h"
+#include "OscLatency.h"
+#include "OscStats.h"
+#include "OscBacklog.h"
+#include <unordered_set>
+#include <queue>
 
 /// a threaded osc receiver, add child OscObjects to process messages
+///
+/// raw packets are queued by one or more OscListeners, each with its own
+/// thread, and decoded & processed on the main thread when update() is called,
+/// usually once per frame
+///
+/// there is always a default udp listener using the port given to setup(),
+/// more can be added for other ports, ie. one bound to "/visual/lights" for
+/// a lighting desk
+///
+/// messages are handed to the OscObjects as OscMessage views into the queued
+/// packet, so nothing is allocated per message
+///
+/// bundles with a future timetag are held until the first update whose time
+/// reaches the tag, all messages in a bundle are applied in the same update
+///
+/// when coalescing, only the newest message for each address is processed on
+/// update, except for trigger addresses which are always processed in order
+///
+/// received packets can be recorded to a log file & replayed later through
+/// an OscReplayListener
+///
+/// while ignoring messages, ie. when paused, a bounded backlog of the newest
+/// message for each address & the triggers is kept and applied on the first
+/// update after messages are no longer ignored
 class OscReceiver {
 
 	public:
@@ -37,49 +72,212 @@ class OscReceiver {
 		/// calls setup automatically
 		OscReceiver(unsigned int port);
 
-		/// setup the udp socket using the given port
-		/// returns false if socket cannot be setup
+		/// set the port of the default udp listener, only restarts the default
+		/// listener if running, returns false if it can't be restarted
 		bool setup(unsigned int port);
 
-		/// start the listening thread, opens connection
+		/// start the listening threads, opens connections
 		void start();
 
-		/// stop the listening thread, closes connection
+		/// stop the listening threads, closes connections
 		void stop();
 		
+		/// process the packets received since the last update,
+		/// call this from the main thread
+		void update();
+		
 		/// attach osc objects to handle messages, does not delete
 		void addOscObject(OscObject *object);
 		void removeOscObject(OscObject *object);
 
-		/// is the thread running?
-		bool isListening() {return m_receiver != NULL;}
+		/// is the receiver running?
+		bool isListening() {return m_bIsRunning;}
 
-		/// get port num
+		/// get the default udp listener port num
 		unsigned int getPort();
+		
+		/// add a listener, started now if the receiver is running
+		/// returns false if already added or it couldn't be started
+		bool addListener(ofPtr<OscListener> listener);
+		
+		/// add a udp listener on a port, optionally bound to an address subtree,
+		/// returns the listener or NULL if it couldn't be started
+		ofPtr<OscUdpListener> addUdpListener(unsigned int port, const string &subtree="");
+		
+		/// add a SLIP framed tcp listener on a port, optionally bound to an address
+		/// subtree, returns the listener or NULL if it couldn't be started
+		ofPtr<OscTcpListener> addTcpListener(unsigned int port, const string &subtree="");
+		
+		/// add a POSIX shared memory listener for same host senders, with a ring
+		/// size in bytes, 0 for the default, optionally bound to an address
+		/// subtree, returns the listener or NULL if it couldn't be started
+		ofPtr<OscShmListener> addShmListener(const string &name, unsigned int size=0,
+		                                     const string &subtree="");
+		
+		/// add a listener replaying a log written by startRecording(), in real time
+		/// or as fast as possible, returns the listener or NULL if it couldn't
+		/// be started
+		ofPtr<OscReplayListener> addReplayListener(const string &path, bool fast=false);
+		
+		/// stop & remove a listener, the default listener can't be removed
+		void removeListener(ofPtr<OscListener> listener);
+		
+		/// get the listeners, the default udp listener is at index 0
+		unsigned int getNumListeners() {return m_listeners.size();}
+		ofPtr<OscListener> getListener(unsigned int index);
 
 		/// ignore incoming messages?
+		///
+		/// ignored messages are held in the backlog, if enabled, and applied
+		/// on the first update after no longer ignoring
 		void ignoreMessages(bool yesno);
+		bool isIgnoringMessages() {return m_bIgnoreMessages;}
+		
+		/// messages held while ignoring, see OscBacklog for the capacity &
+		/// overflow settings, set a capacity of 0 to discard ignored messages
+		OscBacklog& getBacklog() {return m_backlog;}
+		
+		/// set the max number of packets queued between updates for each listener,
+		/// rounded up to the next power of 2, can't be set while running
+		bool setQueueSize(unsigned int size);
+		unsigned int getQueueSize() {return m_queueSize;}
+		
+		/// set the socket receive buffer size in bytes for udp listeners added
+		/// after & the default listener, 0 for the system default,
+		/// can't be set while running (linux only)
+		bool setReceiveBufferSize(unsigned int size);
+		unsigned int getReceiveBufferSize() {return m_receiveBufferSize;}
+		
+		/// set the max number of future timetagged bundles held until they are
+		/// due, bundles arriving while full are dropped
+		void setMaxScheduled(unsigned int max) {m_maxScheduled = max;}
+		unsigned int getMaxScheduled() {return m_maxScheduled;}
+		
+		/// set the time from update until the frame is shown in seconds,
+		/// usually the frame period, bundles timetagged before then are
+		/// applied in this update so they land on the intended frame,
+		/// 0 to compare timetags against the update time
+		void setPresentationDelay(double seconds);
+		
+		/// number of bundles waiting for their timetag
+		unsigned int getNumScheduled() {return m_scheduled.size();}
+		
+		/// only process the newest message for each address on update?
+		void setCoalesce(bool coalesce) {m_bCoalesce = coalesce;}
+		bool getCoalesce() {return m_bCoalesce;}
+		
+		/// addresses which are never coalesced, ie. "/visual/scene/next"
+		void addTrigger(const string &address);
+		void removeTrigger(const string &address);
+		void clearTriggers();
+		bool isTrigger(const string &address);
+		
+		/// record received packets to a log file on update, stamped with their
+		/// arrival time on the listener thread, replayed packets are skipped,
+		/// replaces any existing file, returns false if it can't be opened
+		bool startRecording(const string &path);
+		
+		/// flush & close the recording log file
+		void stopRecording() {m_recorder.close();}
+		
+		/// is a recording log file open?
+		bool isRecording() {return m_recorder.isOpen();}
+		
+		/// message latency stats, stamped on dispatch when enabled
+		OscLatency& getLatency() {return m_latency;}
+		
+		/// per address prefix message counts & handler time, counted on
+		/// dispatch when enabled
+		OscStats& getStats() {return m_stats;}
+		
+		/// packet & message counters, totals for all listeners
+		unsigned int getNumReceived();
+		unsigned int getNumDropped(); //< queue full, too big, or too many scheduled
+		unsigned int getNumCoalesced() {return m_numCoalesced;} //< older messages skipped
+		unsigned int getNumSocketDropped(); //< by the kernel (linux only)
+		void resetCounters();
 
 	protected:
 	
-		/// handles message
-		void processMessage(const ofxOscMessage &message);
-		
-		/// wrapper to override and implement message processing
-		class Receiver : public ofxOscReceiver {
-			public:
-				Receiver() : ofxOscReceiver(), receiver(NULL) {}
-				OscReceiver *receiver;
-			protected:
-				void ProcessMessage(const osc::ReceivedMessage &m,
-					const osc::IpEndpointName& remoteEndpoint);
-		};
-		friend Receiver;
+		/// hold a copy of a packet until its timetag, returns false if full
+		bool schedulePacket(const OscPacket &packet, uint64_t timeTag,
+		                    ofPtr<OscListener> listener);
+		
+		/// decode packets into the message list,
+		/// skips messages outside of the listener's subtree
+		void collectPacket(const OscPacket &packet, OscListener *listener);
+		void collectBundle(const osc::ReceivedBundle &bundle,
+		                   const OscPacket &packet, OscListener *listener);
+		void collectMessage(const char *data, unsigned int size,
+		                    const OscPacket &packet, OscListener *listener);
+		
+		/// add the backlog messages to the message list
+		void collectBacklog();
+		
+		/// mark all but the newest message for each non-trigger address as skipped
+		void coalesce();
 		
-		unsigned int m_port;
-		ofPtr<Receiver> m_receiver;
+		/// handles message, returns true if an object handled it
+		bool processMessage(const OscMessage &message);
+		
+		ofPtr<OscUdpListener> m_udpListener; //< default listener
+		vector<ofPtr<OscListener> > m_listeners; //< all listeners, default first
+		vector<unsigned int> m_counts; //< packets taken from each listener on update
+		unsigned int m_queueSize;
+		unsigned int m_receiveBufferSize;
 		bool m_bIsRunning, m_bIgnoreMessages;
 		vector<OscObject*> _objectList; //< list of osc objects
 	
-		ofMutex mutex; //< mutex between main & osc threads
+		unsigned int m_numDropped; //< scheduling drops, listeners count their own
+		unsigned int m_numDroppedReported; //< dropped count last warned about
+		
+		/// a message decoded from a queued packet, valid until the packet is popped
+		struct QueuedMessage {
+			QueuedMessage(const char *data, unsigned int size,
+			              const osc::IpEndpointName &endpoint, uint64_t time) :
+				message(osc::ReceivedPacket(data, (int) size)), data(data), size(size),
+				endpoint(endpoint), time(time), bSkip(false) {}
+			osc::ReceivedMessage message;
+			const char *data; //< message bytes
+			unsigned int size;
+			osc::IpEndpointName endpoint;
+			uint64_t time; //< packet receive time
+			bool bSkip; //< superseded by a newer message
+		};
+		vector<QueuedMessage> m_messages; //< messages for the current update
+		vector<string> m_addresses; //< reused address buffers, one per message
+		vector<unsigned int> m_order; //< reused sort buffer for coalescing
+		
+		/// a packet copy waiting for its timetag
+		struct ScheduledPacket {
+			ScheduledPacket(uint64_t timeTag, unsigned int order,
+			                ofPtr<OscPacket> packet, ofPtr<OscListener> listener) :
+				timeTag(timeTag), order(order), packet(packet), listener(listener) {}
+			uint64_t timeTag;
+			unsigned int order; //< keeps arrival order for equal tags
+			ofPtr<OscPacket> packet;
+			ofPtr<OscListener> listener; //< received by
+			bool operator>(const ScheduledPacket &p) const {
+				return timeTag > p.timeTag || (timeTag == p.timeTag && order > p.order);
+			}
+		};
+		priority_queue<ScheduledPacket, vector<ScheduledPacket>,
+		               std::greater<ScheduledPacket> > m_scheduled; //< soonest first
+		vector<ofPtr<OscPacket> > m_due; //< scheduled packets applied this update
+		vector<ofPtr<OscPacket> > m_packetPool; //< reused packet copies
+		unsigned int m_maxScheduled;
+		uint64_t m_presentationDelay; //< as a timetag duration
+		unsigned int m_scheduledOrder;
+		
+		bool m_bCoalesce;
+		unordered_set<string> m_triggers;
+		unsigned int m_numCoalesced;
+		
+		OscRecorder m_recorder;
+		OscLatency m_latency;
+		OscStats m_stats;
+		
+		OscBacklog m_backlog;
+		vector<const OscBacklog::Entry*> m_backlogEntries; //< reused
+		bool m_bBacklogCollected; //< backlog messages are in the current update
 };
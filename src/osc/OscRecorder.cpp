@@ -0,0 +1,162 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscRecorder.h"
+
+// stdio write buffer size
+#define WRITE_BUFFER_SIZE 262144
+
+// little endian helpers
+static inline void putUInt(char *dest, uint64_t u, unsigned int bytes) {
+	for(unsigned int i = 0; i < bytes; ++i) {
+		dest[i] = (char)(u >> (i * 8));
+	}
+}
+
+static inline uint64_t getUInt(const char *src, unsigned int bytes) {
+	uint64_t u = 0;
+	for(unsigned int i = 0; i < bytes; ++i) {
+		u |= (uint64_t)(unsigned char) src[i] << (i * 8);
+	}
+	return u;
+}
+
+//--------------------------------------------------------------
+OscRecorder::OscRecorder() : file(NULL), startTime(0), numRecorded(0) {}
+
+//--------------------------------------------------------------
+OscRecorder::~OscRecorder() {
+	close();
+}
+
+//--------------------------------------------------------------
+bool OscRecorder::open(const string &path) {
+	close();
+	file = fopen(path.c_str(), "wb");
+	if(!file) {
+		ofLogError() << "OscRecorder: couldn't open \"" << path << "\": " << strerror(errno);
+		return false;
+	}
+	buffer.resize(WRITE_BUFFER_SIZE);
+	setvbuf(file, &buffer[0], _IOFBF, buffer.size());
+	
+	char header[12];
+	memcpy(header, OSC_LOG_MAGIC, 8); // includes null
+	putUInt(header+8, OSC_LOG_VERSION, 4);
+	fwrite(header, 1, sizeof(header), file);
+	
+	this->path = path;
+	startTime = oscMonotonicTime();
+	numRecorded = 0;
+	ofLogVerbose() << "OscRecorder: recording to \"" << path << "\"";
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscRecorder::close() {
+	if(!file) {
+		return;
+	}
+	fclose(file);
+	file = NULL;
+	ofLogVerbose() << "OscRecorder: recorded " << numRecorded << " packet(s) to \"" << path << "\"";
+}
+
+//--------------------------------------------------------------
+void OscRecorder::record(const OscPacket &packet) {
+	if(!file) {
+		return;
+	}
+	char header[18];
+	putUInt(header, packet.time > startTime ? packet.time - startTime : 0, 8);
+	putUInt(header+8, packet.endpoint.address, 4);
+	putUInt(header+12, packet.endpoint.port, 2);
+	putUInt(header+14, packet.size, 4);
+	if(fwrite(header, 1, sizeof(header), file) != sizeof(header) ||
+	   fwrite(packet.getData(), 1, packet.size, file) != packet.size) {
+		ofLogError() << "OscRecorder: write failed, stopping: " << strerror(errno);
+		close();
+		return;
+	}
+	numRecorded++;
+}
+
+//--------------------------------------------------------------
+FILE* OscRecorder::openLog(const string &path) {
+	FILE *file = fopen(path.c_str(), "rb");
+	if(!file) {
+		ofLogError() << "OscRecorder: couldn't open \"" << path << "\": " << strerror(errno);
+		return NULL;
+	}
+	char header[12];
+	if(fread(header, 1, sizeof(header), file) != sizeof(header) ||
+	   memcmp(header, OSC_LOG_MAGIC, 8) != 0) {
+		ofLogError() << "OscRecorder: \"" << path << "\" is not an osc log";
+		fclose(file);
+		return NULL;
+	}
+	if(getUInt(header+8, 4) != OSC_LOG_VERSION) {
+		ofLogError() << "OscRecorder: \"" << path << "\" has unknown version "
+			<< getUInt(header+8, 4);
+		fclose(file);
+		return NULL;
+	}
+	return file;
+}
+
+//--------------------------------------------------------------
+bool OscRecorder::readRecord(FILE *file, uint64_t &time, OscPacket &packet,
+                             unsigned int maxSize) {
+	char header[18];
+	unsigned int size;
+	while(true) {
+		if(fread(header, 1, sizeof(header), file) != sizeof(header)) {
+			return false;
+		}
+		size = getUInt(header+14, 4);
+		if(size <= maxSize) {
+			break;
+		}
+		
+		// too big or corrupt, a bad size runs past the end & stops the next read
+		ofLogWarning() << "OscRecorder: skipping " << size << " byte record, max is " << maxSize;
+		if(fseek(file, size, SEEK_CUR) != 0) {
+			return false;
+		}
+	}
+	time = getUInt(header, 8);
+	packet.endpoint = osc::IpEndpointName(getUInt(header+8, 4), getUInt(header+12, 2));
+	
+	// read straight into the packet storage
+	char *data = packet.data;
+	if(size > OSC_MAX_PACKET_SIZE) {
+		if(packet.large.size() < size) {
+			packet.large.resize(size);
+		}
+		data = &packet.large[0];
+	}
+	if(fread(data, 1, size, file) != size) {
+		return false;
+	}
+	packet.size = size;
+	return true;
+}
@@ -0,0 +1,88 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+
+/// osc log file header: magic & format version
+#define OSC_LOG_MAGIC "VOSCLOG"
+#define OSC_LOG_VERSION 1
+
+/// records received osc packets to a compact binary log for replay
+///
+/// the file starts with the 8 byte magic string & a uint32 version, followed
+/// by one record per packet, all little endian:
+///
+///     uint64  microseconds since recording started
+///     uint32  sender ip address
+///     uint16  sender port
+///     uint32  packet size
+///     ...     packet bytes
+///
+/// records are written through a large stdio buffer, so the disk is only hit
+/// every few hundred kilobytes
+class OscRecorder {
+
+	public:
+	
+		OscRecorder();
+		virtual ~OscRecorder();
+		
+		/// open a log file for writing, replaces any existing file,
+		/// returns false if it can't be opened
+		bool open(const string &path);
+		
+		/// flush & close the log file
+		void close();
+		
+		/// is a log file open?
+		bool isOpen() {return file != NULL;}
+		
+		/// get the current log file path
+		const string& getPath() {return path;}
+		
+		/// append a packet, stamped with its receive time, ie. the time the
+		/// listener thread queued it rather than when it's recorded
+		void record(const OscPacket &packet);
+		
+		/// number of packets recorded to the current file
+		unsigned int getNumRecorded() {return numRecorded;}
+		
+		/// read the next record from a log file opened with openLog(), records
+		/// over maxSize are skipped without allocating, returns false at the
+		/// end of the file or if the record is truncated
+		static bool readRecord(FILE *file, uint64_t &time, OscPacket &packet,
+		                       unsigned int maxSize=OSC_MAX_STREAM_PACKET_SIZE);
+		
+		/// open a log file for reading & check the header,
+		/// returns NULL if it can't be opened or isn't an osc log
+		static FILE* openLog(const string &path);
+	
+	protected:
+	
+		FILE *file;
+		string path;
+		vector<char> buffer; //< stdio write buffer
+		uint64_t startTime; //< monotonic time when opened
+		unsigned int numRecorded;
+};
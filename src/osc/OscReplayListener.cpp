@@ -0,0 +1,142 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscReplayListener.h"
+
+#include "OscRecorder.h"
+#include <thread>
+
+// how often the thread wakes to check if it should stop
+#define WAIT_TIMEOUT_US 100000
+
+//--------------------------------------------------------------
+OscReplayListener::OscReplayListener(const string &path, bool fast) :
+	path(path), bFast(fast), bReplaying(false), file(NULL), bFinished(false) {
+	maxPacketSize = OSC_MAX_STREAM_PACKET_SIZE;
+}
+
+//--------------------------------------------------------------
+OscReplayListener::~OscReplayListener() {
+	stop();
+}
+
+//--------------------------------------------------------------
+bool OscReplayListener::start() {
+	if(bReplaying) {
+		ofLogWarning() << "OscReplayListener: already replaying \"" << path << "\"";
+		return false;
+	}
+	file = OscRecorder::openLog(path);
+	if(!file) {
+		return false;
+	}
+	bFinished = false;
+	bReplaying = true;
+	startThread(false);
+	ofLogNotice() << "OscReplayListener: replaying \"" << path << "\""
+		<< (bFast ? " as fast as possible" : "");
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscReplayListener::stop() {
+	if(!bReplaying) {
+		return;
+	}
+	waitForThread(true);
+	fclose(file);
+	file = NULL;
+	bReplaying = false;
+}
+
+//--------------------------------------------------------------
+bool OscReplayListener::setPath(const string &path) {
+	if(bReplaying) {
+		ofLogWarning() << "OscReplayListener: can't set path while replaying";
+		return false;
+	}
+	this->path = path;
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscReplayListener::setFast(bool fast) {
+	if(bReplaying) {
+		ofLogWarning() << "OscReplayListener: can't set fast while replaying";
+		return false;
+	}
+	bFast = fast;
+	return true;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscReplayListener::threadedFunction() {
+	uint64_t startTime = oscMonotonicTime();
+	uint64_t recordedTime;
+	while(isThreadRunning()) {
+	
+		// as fast as possible: wait for space instead of dropping
+		OscPacket *packet = queue.back();
+		if(bFast) {
+			while(packet == NULL && isThreadRunning()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				packet = queue.back();
+			}
+			if(packet == NULL) {
+				break;
+			}
+		}
+		
+		// read straight into the free slot, if any
+		OscPacket *dest = (packet != NULL ? packet : &scratch);
+		if(!OscRecorder::readRecord(file, recordedTime, *dest, maxPacketSize)) {
+			ofLogNotice() << "OscReplayListener: finished \"" << path << "\"";
+			break;
+		}
+		if(!bFast && !waitUntil(startTime + recordedTime)) {
+			break;
+		}
+		
+		numReceived++;
+		if(packet == NULL) {
+			numDropped++;
+			continue;
+		}
+		packet->time = oscMonotonicTime();
+		queue.push();
+	}
+	bFinished = true;
+}
+
+//--------------------------------------------------------------
+bool OscReplayListener::waitUntil(uint64_t time) {
+	while(isThreadRunning()) {
+		uint64_t now = oscMonotonicTime();
+		if(now >= time) {
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::microseconds(
+			std::min<uint64_t>(time - now, WAIT_TIMEOUT_US)));
+	}
+	return false;
+}
@@ -0,0 +1,78 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscListener.h"
+
+/// replays a log written by OscRecorder as if the packets were being received,
+/// so they go through the same scheduling, coalescing, & dispatch as live
+/// traffic
+///
+/// in real time mode, packets are queued with their recorded spacing & are
+/// dropped when the queue is full, like a live listener, otherwise they are
+/// queued as fast as the receiver takes them without dropping any
+///
+/// note: recorded bundle timetags are in the past, so they apply immediately
+class OscReplayListener : public OscListener, protected ofThread {
+
+	public:
+	
+		OscReplayListener(const string &path="", bool fast=false);
+		virtual ~OscReplayListener();
+		
+		/// open the log file & start the replay thread
+		bool start();
+		
+		/// stop the replay thread & close the log file
+		void stop();
+		
+		bool isListening() {return bReplaying;}
+		string getName() {return "replay "+ofFilePath::getFileName(path);}
+		bool isRecordable() {return false;}
+		
+		/// set the log file path, can't be set while replaying
+		bool setPath(const string &path);
+		const string& getPath() {return path;}
+		
+		/// replay as fast as possible instead of in real time?
+		/// can't be set while replaying
+		bool setFast(bool fast);
+		bool getFast() {return bFast;}
+		
+		/// has the whole log been queued?
+		bool isFinished() {return bFinished;}
+	
+	protected:
+	
+		void threadedFunction();
+		
+		/// wait until a monotonic time, returns false if stopped first
+		bool waitUntil(uint64_t time);
+	
+		string path;
+		bool bFast;
+		bool bReplaying;
+		FILE *file; //< replay thread only while replaying
+		OscPacket scratch; //< read into when the queue is full
+		std::atomic<bool> bFinished;
+};
@@ -0,0 +1,142 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+/// bounded, lock-free single producer/single consumer ring buffer
+///
+/// slots are preallocated & reused, so the producer fills the slot returned
+/// by back() then commits it with push() and the consumer reads the slot
+/// returned by front() then releases it with pop()
+///
+/// only one thread may produce and only one thread may consume at a time,
+/// setCapacity() & clear() are not thread safe
+template<class T>
+class OscRingBuffer {
+
+	public:
+
+		OscRingBuffer(unsigned int capacity=0) : mask(0), head(0), tail(0) {
+			setCapacity(capacity);
+		}
+		
+		/// set the number of slots, rounded up to the next power of 2
+		void setCapacity(unsigned int capacity) {
+			unsigned int size = 1;
+			while(size < capacity) {
+				size <<= 1;
+			}
+			slots.clear();
+			slots.resize(size);
+			mask = size-1;
+			clear();
+		}
+		unsigned int getCapacity() const {return slots.size();}
+
+		/// producer: get the next free slot, returns NULL if full
+		T* back() {
+			unsigned int h = head.load(std::memory_order_relaxed);
+			if(h - tail.load(std::memory_order_acquire) >= slots.size()) {
+				return NULL;
+			}
+			return &slots[h & mask];
+		}
+		
+		/// producer: commit the slot returned by back()
+		void push() {
+			head.store(head.load(std::memory_order_relaxed)+1, std::memory_order_release);
+		}
+		
+		/// producer: get the free slot at an index from the next free slot,
+		/// returns NULL if not free
+		T* back(unsigned int index) {
+			unsigned int h = head.load(std::memory_order_relaxed)+index;
+			if(h - tail.load(std::memory_order_acquire) >= slots.size()) {
+				return NULL;
+			}
+			return &slots[h & mask];
+		}
+		
+		/// producer: commit a number of slots returned by back(index)
+		void push(unsigned int count) {
+			head.store(head.load(std::memory_order_relaxed)+count, std::memory_order_release);
+		}
+		
+		/// producer: copy an item into the next free slot,
+		/// returns false if full
+		bool push(const T &item) {
+			T *slot = back();
+			if(slot == NULL) {
+				return false;
+			}
+			*slot = item;
+			push();
+			return true;
+		}
+
+		/// consumer: get the oldest filled slot, returns NULL if empty
+		T* front() {
+			unsigned int t = tail.load(std::memory_order_relaxed);
+			if(t == head.load(std::memory_order_acquire)) {
+				return NULL;
+			}
+			return &slots[t & mask];
+		}
+		
+		/// consumer: release the slot returned by front()
+		void pop() {
+			tail.store(tail.load(std::memory_order_relaxed)+1, std::memory_order_release);
+		}
+		
+		/// consumer: get the filled slot at an index from the front,
+		/// does not check if index < size()
+		T* at(unsigned int index) {
+			return &slots[(tail.load(std::memory_order_relaxed)+index) & mask];
+		}
+		
+		/// consumer: release a number of slots from the front
+		void pop(unsigned int count) {
+			tail.store(tail.load(std::memory_order_relaxed)+count, std::memory_order_release);
+		}
+		
+		/// number of filled slots
+		unsigned int size() const {
+			return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+		}
+		bool empty() const {return size() == 0;}
+		
+		/// reset to empty, keeps the slots
+		void clear() {
+			head.store(0);
+			tail.store(0);
+		}
+
+	private:
+
+		std::vector<T> slots;
+		unsigned int mask; //< slot index mask, capacity is a power of 2
+		std::atomic<unsigned int> head; //< write position, producer owned
+		std::atomic<unsigned int> tail; //< read position, consumer owned
+};
@@ -0,0 +1,404 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscSender.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <errno.h>
+
+// default max bundle size, fits in an ethernet frame
+#define DEFAULT_MAX_BUNDLE_SIZE 1400
+
+// max number of packets waiting for the sender thread
+#define QUEUE_SIZE 256
+
+// fallback thread wake up, it is woken when packets are queued & on stop
+#define WAIT_TIMEOUT_MS 100
+
+// bundle header: "#bundle" & immediate timetag
+static const char BUNDLE_HEADER[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+// osc data is big endian & padded to 4 bytes
+static inline void writeUInt32(vector<char> &dest, uint32_t u) {
+	dest.push_back((char)(u >> 24));
+	dest.push_back((char)(u >> 16));
+	dest.push_back((char)(u >> 8));
+	dest.push_back((char) u);
+}
+
+static inline void writeUInt64(vector<char> &dest, uint64_t u) {
+	writeUInt32(dest, (uint32_t)(u >> 32));
+	writeUInt32(dest, (uint32_t) u);
+}
+
+static inline void writePadded(vector<char> &dest, const char *data, unsigned int size) {
+	dest.insert(dest.end(), data, data+size);
+	dest.resize(dest.size() + (4 - (size % 4)) % 4, 0);
+}
+
+static inline void writeString(vector<char> &dest, const string &s) {
+	dest.insert(dest.end(), s.begin(), s.end());
+	dest.resize(dest.size() + 4 - (s.size() % 4), 0); // at least one null
+}
+
+/// resolved destination address
+struct OscSender::Destination {
+	struct sockaddr_in address;
+};
+
+//--------------------------------------------------------------
+OscSender::OscSender() :
+	flushPolicy(FLUSH_FRAME), flushInterval(0), lastFlushTime(0),
+	maxBundleSize(DEFAULT_MAX_BUNDLE_SIZE), bundleCount(0), bundleFirst(0),
+	queue(QUEUE_SIZE), socket(-1), port(0),
+	numMessages(0), numPackets(0), numBytes(0), numDropped(0) {}
+
+//--------------------------------------------------------------
+OscSender::~OscSender() {
+	stop();
+}
+
+//--------------------------------------------------------------
+void OscSender::setup(const string &host, unsigned int port) {
+	
+	// resolve, allowing host names
+	struct addrinfo hints, *result = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	if(getaddrinfo(host.c_str(), NULL, &hints, &result) != 0 || result == NULL) {
+		ofLogError() << "OscSender: couldn't resolve \"" << host << "\"";
+		return;
+	}
+	ofPtr<Destination> d(new Destination);
+	memcpy(&d->address, result->ai_addr, sizeof(struct sockaddr_in));
+	d->address.sin_port = htons(port);
+	freeaddrinfo(result);
+	
+	if(socket < 0) {
+		socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+		if(socket < 0) {
+			ofLogError() << "OscSender: couldn't create socket: " << strerror(errno);
+			return;
+		}
+		int on = 1;
+		setsockopt(socket, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		destination = d;
+		this->host = host;
+		this->port = port;
+	}
+	
+	if(!isThreadRunning()) {
+		startThread(false);
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::stop() {
+	if(!isThreadRunning()) {
+		return;
+	}
+	flush();
+	
+	// the thread sends what's left before exiting, stop under the mutex so
+	// the thread can't miss the wake up between checking & waiting
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopThread();
+		condition.notify_one();
+	}
+	waitForThread(false);
+	
+	if(socket >= 0) {
+		close(socket);
+		socket = -1;
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::sendMessage(const ofxOscMessage &message) {
+	encoded.clear();
+	encodeMessage(message, encoded);
+	sendEncoded(&encoded[0], encoded.size());
+}
+
+//--------------------------------------------------------------
+void OscSender::sendBundle(const ofxOscBundle &bundle) {
+	
+	// keep ordering with the current bundle
+	flush();
+	
+	encoded.clear();
+	encodeBundle(bundle, encoded);
+	numMessages += bundle.getMessageCount();
+	if(!queuePacket(&encoded[0], encoded.size())) {
+		numDropped++;
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::sendEncoded(const char *data, unsigned int size) {
+	numMessages++;
+	if(flushPolicy == FLUSH_IMMEDIATE) {
+		if(!queuePacket(data, size)) {
+			numDropped++;
+		}
+		return;
+	}
+	queueMessage(data, size);
+}
+
+//--------------------------------------------------------------
+void OscSender::update() {
+	switch(flushPolicy) {
+		case FLUSH_FRAME:
+			flush();
+			break;
+		case FLUSH_INTERVAL:
+			if(ofGetElapsedTimeMillis() - lastFlushTime >= flushInterval) {
+				flush();
+			}
+			break;
+		case FLUSH_IMMEDIATE:
+			break;
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::flush() {
+	lastFlushTime = ofGetElapsedTimeMillis();
+	if(bundleCount > 0) {
+	
+		// send a lone message as is
+		bool queued;
+		if(bundleCount == 1) {
+			queued = queuePacket(&bundle[bundleFirst], bundle.size()-bundleFirst);
+		}
+		else {
+			queued = queuePacket(&bundle[0], bundle.size());
+		}
+		if(!queued) {
+			numDropped += bundleCount;
+		}
+		bundle.clear(); // keeps capacity
+		bundleCount = 0;
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::setFlushPolicy(FlushPolicy policy, unsigned int intervalMS) {
+	if(policy == FLUSH_IMMEDIATE) {
+		flush();
+	}
+	flushPolicy = policy;
+	flushInterval = intervalMS;
+}
+
+//--------------------------------------------------------------
+void OscSender::setMaxBundleSize(unsigned int size) {
+	if(size < sizeof(BUNDLE_HEADER)+8) {
+		ofLogWarning() << "OscSender: max bundle size too small: " << size;
+		return;
+	}
+	flush();
+	maxBundleSize = size;
+}
+
+//--------------------------------------------------------------
+void OscSender::resetCounters() {
+	numMessages = 0;
+	numPackets = 0;
+	numBytes = 0;
+	numDropped = 0;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscSender::threadedFunction() {
+	while(true) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait_for(lock, std::chrono::milliseconds(WAIT_TIMEOUT_MS), [this] {
+				return !queue.empty() || !isThreadRunning();
+			});
+		}
+		
+		// latest destination
+		ofPtr<Destination> d;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			d = destination;
+		}
+		
+		// send everything waiting, then exit if stopped
+		OscPacket *packet;
+		while((packet = queue.front()) != NULL) {
+			ssize_t sent = sendto(socket, packet->getData(), packet->size, 0,
+				(struct sockaddr *) &d->address, sizeof(struct sockaddr_in));
+			if(sent < 0) {
+				numDropped++;
+			}
+			else {
+				numPackets++;
+				numBytes += sent;
+			}
+			queue.pop();
+		}
+		if(!isThreadRunning()) {
+			break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::queueMessage(const char *data, unsigned int size) {
+	
+	// flush if the message won't fit, an empty bundle always takes it
+	if(bundleCount > 0 && bundle.size() + 4 + size > maxBundleSize) {
+		flush();
+	}
+	if(bundleCount == 0) {
+		bundle.insert(bundle.end(), BUNDLE_HEADER, BUNDLE_HEADER+sizeof(BUNDLE_HEADER));
+		bundleFirst = bundle.size() + 4;
+	}
+	writeUInt32(bundle, size);
+	bundle.insert(bundle.end(), data, data+size);
+	bundleCount++;
+}
+
+//--------------------------------------------------------------
+bool OscSender::queuePacket(const char *data, unsigned int size) {
+	OscPacket *packet = queue.back();
+	if(packet == NULL) {
+		return false;
+	}
+	packet->set(data, size);
+	
+	// push & wake under the mutex so the thread either sees the packet
+	// before waiting or gets the notify
+	std::lock_guard<std::mutex> lock(mutex);
+	queue.push();
+	condition.notify_one();
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscSender::encodeMessage(const ofxOscMessage &message, vector<char> &dest) {
+	writeString(dest, message.getAddress());
+	
+	// type tags
+	string tags = ",";
+	for(int i = 0; i < message.getNumArgs(); ++i) {
+		switch(message.getArgType(i)) {
+			case OFXOSC_TYPE_TRUE: case OFXOSC_TYPE_FALSE:
+				tags += message.getArgAsBool(i) ? 'T' : 'F';
+				break;
+			default:
+				tags += (char) message.getArgType(i);
+				break;
+		}
+	}
+	writeString(dest, tags);
+	
+	// args
+	for(int i = 0; i < message.getNumArgs(); ++i) {
+		switch(message.getArgType(i)) {
+			case OFXOSC_TYPE_INT32:
+				writeUInt32(dest, (uint32_t) message.getArgAsInt32(i));
+				break;
+			case OFXOSC_TYPE_INT64:
+				writeUInt64(dest, (uint64_t) message.getArgAsInt64(i));
+				break;
+			case OFXOSC_TYPE_FLOAT: {
+				float f = message.getArgAsFloat(i);
+				uint32_t u;
+				memcpy(&u, &f, sizeof(float));
+				writeUInt32(dest, u);
+				break;
+			}
+			case OFXOSC_TYPE_DOUBLE: {
+				double d = message.getArgAsDouble(i);
+				uint64_t u;
+				memcpy(&u, &d, sizeof(double));
+				writeUInt64(dest, u);
+				break;
+			}
+			case OFXOSC_TYPE_STRING:
+				writeString(dest, message.getArgAsString(i));
+				break;
+			case OFXOSC_TYPE_SYMBOL:
+				writeString(dest, message.getArgAsSymbol(i));
+				break;
+			case OFXOSC_TYPE_CHAR:
+				writeUInt32(dest, (uint32_t) message.getArgAsChar(i));
+				break;
+			case OFXOSC_TYPE_MIDI_MESSAGE:
+				writeUInt32(dest, message.getArgAsMidiMessage(i));
+				break;
+			case OFXOSC_TYPE_RGBA_COLOR:
+				writeUInt32(dest, message.getArgAsRgbaColor(i));
+				break;
+			case OFXOSC_TYPE_TIMETAG:
+				writeUInt64(dest, message.getArgAsTimetag(i));
+				break;
+			case OFXOSC_TYPE_BLOB: {
+				ofBuffer blob = message.getArgAsBlob(i);
+				writeUInt32(dest, blob.size());
+				writePadded(dest, blob.getData(), blob.size());
+				break;
+			}
+			default: // no data: T, F, N, I
+				break;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void OscSender::encodeBundle(const ofxOscBundle &bundle, vector<char> &dest) {
+	dest.insert(dest.end(), BUNDLE_HEADER, BUNDLE_HEADER+sizeof(BUNDLE_HEADER));
+	for(int i = 0; i < bundle.getBundleCount(); ++i) {
+		unsigned int start = dest.size();
+		writeUInt32(dest, 0); // size placeholder
+		encodeBundle(bundle.getBundleAt(i), dest);
+		uint32_t size = dest.size() - start - 4;
+		for(unsigned int b = 0; b < 4; ++b) {
+			dest[start+b] = (char)(size >> (24 - b*8));
+		}
+	}
+	for(int i = 0; i < bundle.getMessageCount(); ++i) {
+		unsigned int start = dest.size();
+		writeUInt32(dest, 0); // size placeholder
+		encodeMessage(bundle.getMessageAt(i), dest);
+		uint32_t size = dest.size() - start - 4;
+		for(unsigned int b = 0; b < 4; ++b) {
+			dest[start+b] = (char)(size >> (24 - b*8));
+		}
+	}
+}
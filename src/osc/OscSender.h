@@ -0,0 +1,124 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+#include "OscRingBuffer.h"
+#include <condition_variable>
+
+/// an asynchronous, batching osc sender
+///
+/// messages are encoded when sent & packed into size limited bundles, which
+/// are handed to a sender thread when flushed so the caller never waits on a
+/// socket, by default everything sent during a frame is flushed by update()
+///
+/// a bundle holding a single message is sent as a plain message
+///
+/// note: send from the main thread only
+class OscSender : protected ofThread {
+
+	public:
+	
+		/// when queued messages are handed to the sender thread
+		enum FlushPolicy {
+			FLUSH_FRAME,     //< on each update, ie. once per frame
+			FLUSH_INTERVAL,  //< on update when the flush interval has passed
+			FLUSH_IMMEDIATE  //< each message as it's sent, no bundling
+		};
+	
+		OscSender();
+		virtual ~OscSender();
+		
+		/// set the destination host & port, starts the sender thread if needed
+		void setup(const string &host, unsigned int port);
+		
+		/// flush, wait for the sender thread to send everything, & stop it
+		void stop();
+		
+		/// queue a message or bundle
+		void sendMessage(const ofxOscMessage &message);
+		void sendBundle(const ofxOscBundle &bundle);
+		
+		/// queue an already encoded message, ie. a cached one
+		void sendEncoded(const char *data, unsigned int size);
+		
+		/// encode a message or bundle, appends to dest
+		static void encodeMessage(const ofxOscMessage &message, vector<char> &dest);
+		static void encodeBundle(const ofxOscBundle &bundle, vector<char> &dest);
+		
+		/// flush according to the flush policy, call once per frame
+		void update();
+		
+		/// hand the current bundle to the sender thread now
+		void flush();
+		
+		/// set the flush policy & the min ms between flushes for FLUSH_INTERVAL
+		void setFlushPolicy(FlushPolicy policy, unsigned int intervalMS=0);
+		FlushPolicy getFlushPolicy() {return flushPolicy;}
+		unsigned int getFlushInterval() {return flushInterval;}
+		
+		/// set the max bundle size in bytes, messages are added to a new bundle
+		/// when the current one would be larger, a single larger message is
+		/// sent as is
+		void setMaxBundleSize(unsigned int size);
+		unsigned int getMaxBundleSize() {return maxBundleSize;}
+		
+		/// counters
+		unsigned int getNumMessages() {return numMessages;} //< queued
+		unsigned int getNumPackets() {return numPackets;} //< sent
+		unsigned int getNumBytes() {return numBytes;} //< sent
+		unsigned int getNumDropped() {return numDropped;} //< queue full or send error
+		void resetCounters();
+	
+	protected:
+	
+		void threadedFunction();
+		
+		/// add an encoded message to the current bundle, flushes first if full
+		void queueMessage(const char *data, unsigned int size);
+		
+		/// hand a packet to the sender thread, returns false if full
+		bool queuePacket(const char *data, unsigned int size);
+		
+		FlushPolicy flushPolicy;
+		unsigned int flushInterval; //< ms
+		unsigned long long lastFlushTime; //< ms
+		unsigned int maxBundleSize;
+		
+		vector<char> bundle; //< current bundle being packed
+		unsigned int bundleCount; //< messages in the current bundle
+		unsigned int bundleFirst; //< offset of the first message in the bundle
+		vector<char> encoded; //< reused message encoding buffer
+		
+		OscRingBuffer<OscPacket> queue; //< main thread -> sender thread
+		std::mutex mutex; //< guards the destination & queue pushes, wakes the thread
+		std::condition_variable condition;
+		
+		int socket; //< -1 when closed
+		string host;
+		unsigned int port;
+		std::atomic<unsigned int> numMessages, numPackets, numBytes, numDropped;
+		
+		struct Destination; //< resolved address, platform specific
+		ofPtr<Destination> destination; //< guarded by mutex
+};
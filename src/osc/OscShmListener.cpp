@@ -0,0 +1,119 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscShmListener.h"
+
+#include <errno.h>
+
+// default ring size in bytes
+#define DEFAULT_SHM_SIZE (1024*1024)
+
+// how often the thread wakes to check if it should stop
+#define WAIT_TIMEOUT_MS 100
+
+//--------------------------------------------------------------
+OscShmListener::OscShmListener(const string &name, unsigned int size, const string &subtree) :
+	name(name), size(size == 0 ? DEFAULT_SHM_SIZE : size), bListening(false) {
+	setSubtree(subtree);
+}
+
+//--------------------------------------------------------------
+OscShmListener::~OscShmListener() {
+	stop();
+}
+
+//--------------------------------------------------------------
+bool OscShmListener::start() {
+	if(bListening) {
+		ofLogWarning() << "OscShmListener: already listening on " << name;
+		return false;
+	}
+	if(!ring.create(name, size)) {
+		ofLogError() << "OscShmListener: couldn't create shared memory \""
+			<< name << "\": " << strerror(errno);
+		return false;
+	}
+	
+	// a packet can take up to half the ring
+	setMaxPacketSize(ring.getCapacity() / 2);
+	
+	bListening = true;
+	startThread(false);
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscShmListener::stop() {
+	if(!bListening) {
+		return;
+	}
+	waitForThread(true);
+	ring.close();
+	bListening = false;
+}
+
+//--------------------------------------------------------------
+bool OscShmListener::setShmName(const string &name) {
+	if(name == this->name) {
+		return true;
+	}
+	this->name = name;
+	if(bListening) {
+		stop();
+		return start();
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+bool OscShmListener::setShmSize(unsigned int size) {
+	if(size == 0) {
+		size = DEFAULT_SHM_SIZE;
+	}
+	if(size == this->size) {
+		return true;
+	}
+	this->size = size;
+	if(bListening) {
+		stop();
+		return start();
+	}
+	return true;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscShmListener::threadedFunction() {
+	
+	// same host, no port
+	osc::IpEndpointName endpoint(127, 0, 0, 1, 0);
+	
+	while(isThreadRunning()) {
+		uint32_t size;
+		const char *packet;
+		while((packet = ring.front(size)) != NULL) {
+			queuePacket(packet, size, endpoint); // counts drops if full
+			ring.pop();
+		}
+		ring.wait(WAIT_TIMEOUT_MS);
+	}
+}
@@ -0,0 +1,66 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscListener.h"
+#include "OscShmRing.h"
+
+/// POSIX shared memory OscListener for senders on the same host, see
+/// OscShmRing for the layout & a producer example
+///
+/// creates the named ring on start & removes it on stop, only one producer
+/// may write to it at a time
+class OscShmListener : public OscListener, protected ofThread {
+
+	public:
+	
+		OscShmListener(const string &name="", unsigned int size=0, const string &subtree="");
+		virtual ~OscShmListener();
+		
+		/// create the shared memory ring & start the reading thread
+		bool start();
+		
+		/// stop the reading thread & remove the ring
+		void stop();
+		
+		bool isListening() {return bListening;}
+		string getName() {return "shm "+name;}
+		
+		/// set the ring name, ie. "/visual", restarts if listening
+		bool setShmName(const string &name);
+		const string& getShmName() {return name;}
+		
+		/// set the ring size in bytes, rounded up to the next power of 2,
+		/// 0 for the default 1 MB, restarts if listening
+		bool setShmSize(unsigned int size);
+		unsigned int getShmSize() {return size;}
+	
+	protected:
+	
+		void threadedFunction();
+	
+		string name;
+		unsigned int size;
+		bool bListening;
+		OscShmRing ring;
+};
@@ -0,0 +1,278 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+#endif
+
+// shared memory layout, bump the version on changes
+#define OSC_SHM_MAGIC   0x4f534331 // "OSC1"
+#define OSC_SHM_VERSION 1
+
+// packet size which marks the rest of the ring as unused
+#define OSC_SHM_WRAP 0xffffffff
+
+/// lock-free single producer/single consumer ring of osc packets in POSIX
+/// shared memory, for peers on the same host without the socket overhead
+///
+/// the consumer creates the named segment & the producer opens it, each packet
+/// is written as a 4 byte native endian size followed by the packet bytes
+/// padded to 4, a size of OSC_SHM_WRAP means the next packet is at the start
+///
+/// an empty consumer sleeps on a futex in the segment (Linux, elsewhere it
+/// polls every ms) & the producer only wakes it with a syscall if it's asleep
+///
+/// only depends on the standard library, so producers can include it as is:
+///
+///     OscShmRing ring;
+///     if(ring.open("/visual")) {
+///         ring.write(packet, size); // returns false if full
+///     }
+///
+/// note: a producer has to reopen the ring if the consumer restarts
+class OscShmRing {
+
+	public:
+	
+		OscShmRing() : header(NULL), data(NULL), mapSize(0), frontSize(0), bOwner(false) {}
+		virtual ~OscShmRing() {close();}
+		
+		/// consumer: create the named segment with a capacity in bytes, rounded
+		/// up to the next power of 2, replaces an existing segment
+		bool create(const std::string &name, uint32_t capacity) {
+			close();
+			this->name = shmName(name);
+			uint32_t size = 64;
+			while(size < capacity && size < 0x80000000) {
+				size <<= 1;
+			}
+			shm_unlink(this->name.c_str()); // stale
+			int fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+			if(fd < 0) {
+				return false;
+			}
+			mapSize = sizeof(Header) + size;
+			if(ftruncate(fd, mapSize) < 0 || !map(fd)) {
+				::close(fd);
+				shm_unlink(this->name.c_str());
+				mapSize = 0;
+				return false;
+			}
+			::close(fd);
+			bOwner = true;
+			header->version = OSC_SHM_VERSION;
+			header->capacity = size;
+			header->head = 0;
+			header->tail = 0;
+			header->wake = 0;
+			header->sleeping = 0;
+			std::atomic_thread_fence(std::memory_order_release);
+			header->magic = OSC_SHM_MAGIC; // ready
+			return true;
+		}
+		
+		/// producer: open an existing named segment
+		bool open(const std::string &name) {
+			close();
+			this->name = shmName(name);
+			int fd = shm_open(this->name.c_str(), O_RDWR, 0600);
+			if(fd < 0) {
+				return false;
+			}
+			struct stat info;
+			if(fstat(fd, &info) < 0 || (size_t) info.st_size <= sizeof(Header)) {
+				::close(fd);
+				return false;
+			}
+			mapSize = info.st_size;
+			if(!map(fd)) {
+				::close(fd);
+				mapSize = 0;
+				return false;
+			}
+			::close(fd);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(header->magic != OSC_SHM_MAGIC || header->version != OSC_SHM_VERSION ||
+			   sizeof(Header) + header->capacity != mapSize) {
+				close();
+				return false;
+			}
+			return true;
+		}
+		
+		/// unmap, the consumer also removes the named segment
+		void close() {
+			if(header == NULL) {
+				return;
+			}
+			munmap(header, mapSize);
+			if(bOwner) {
+				shm_unlink(name.c_str());
+			}
+			header = NULL;
+			data = NULL;
+			mapSize = 0;
+			bOwner = false;
+		}
+		
+		bool isOpen() const {return header != NULL;}
+		const std::string& getName() const {return name;}
+		uint32_t getCapacity() const {return header ? header->capacity : 0;}
+		
+		/// producer: copy a packet in & wake the consumer if needed,
+		/// returns false if there isn't enough room
+		bool write(const char *packet, uint32_t size) {
+			uint32_t capacity = header->capacity;
+			uint32_t need = 4 + pad(size);
+			if(size == 0 || need > capacity / 2) {
+				return false;
+			}
+			uint32_t h = header->head.load(std::memory_order_relaxed);
+			uint32_t offset = h & (capacity-1);
+			uint32_t skip = (capacity - offset < need ? capacity - offset : 0);
+			if(capacity - (h - header->tail.load(std::memory_order_acquire)) < skip + need) {
+				return false; // full
+			}
+			if(skip > 0) {
+				uint32_t wrap = OSC_SHM_WRAP;
+				memcpy(data + offset, &wrap, 4);
+				offset = 0;
+			}
+			memcpy(data + offset, &size, 4);
+			memcpy(data + offset + 4, packet, size);
+			header->head.store(h + skip + need, std::memory_order_release);
+			
+			// pairs with the fence in wait(), either it sees the new head or
+			// we see it sleeping
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(header->sleeping.load(std::memory_order_relaxed)) {
+				header->wake.fetch_add(1, std::memory_order_relaxed);
+			#ifdef __linux__
+				syscall(SYS_futex, &header->wake, FUTEX_WAKE, 1, NULL, NULL, 0);
+			#endif
+			}
+			return true;
+		}
+		
+		/// consumer: get the next packet & its size, returns NULL if empty,
+		/// a malformed size drops everything queued
+		const char* front(uint32_t &size) {
+			uint32_t capacity = header->capacity;
+			uint32_t t = header->tail.load(std::memory_order_relaxed);
+			uint32_t h = header->head.load(std::memory_order_acquire);
+			while(t != h) {
+				uint32_t offset = t & (capacity-1);
+				memcpy(&size, data + offset, 4);
+				if(size == OSC_SHM_WRAP) {
+					t += capacity - offset;
+					header->tail.store(t, std::memory_order_release);
+					continue;
+				}
+				if(size == 0 || size > capacity || 4 + pad(size) > capacity - offset || 4 + pad(size) > h - t) {
+					header->tail.store(h, std::memory_order_release);
+					return NULL;
+				}
+				frontSize = 4 + pad(size);
+				return data + offset + 4;
+			}
+			return NULL;
+		}
+		
+		/// consumer: release the packet returned by front()
+		void pop() {
+			header->tail.store(header->tail.load(std::memory_order_relaxed) + frontSize,
+			                   std::memory_order_release);
+			frontSize = 0;
+		}
+		
+		/// consumer: sleep until the producer writes or the timeout, returns
+		/// right away if a packet is waiting
+		void wait(unsigned int timeoutMs) {
+			uint32_t wake = header->wake.load(std::memory_order_relaxed);
+			header->sleeping.store(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(header->head.load(std::memory_order_relaxed) ==
+			   header->tail.load(std::memory_order_relaxed)) {
+			#ifdef __linux__
+				struct timespec timeout;
+				timeout.tv_sec = timeoutMs / 1000;
+				timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+				syscall(SYS_futex, &header->wake, FUTEX_WAIT, wake, &timeout, NULL, 0);
+			#else
+				(void) wake;
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			#endif
+			}
+			header->sleeping.store(0, std::memory_order_relaxed);
+		}
+	
+	protected:
+	
+		/// shared header, each position on its own cache line
+		struct Header {
+			uint32_t magic; //< set last by the consumer once ready
+			uint32_t version;
+			uint32_t capacity; //< ring bytes, power of 2
+			alignas(64) std::atomic<uint32_t> head; //< bytes written, producer
+			alignas(64) std::atomic<uint32_t> tail; //< bytes read, consumer
+			alignas(64) std::atomic<uint32_t> wake; //< futex word, bumped to wake
+			std::atomic<uint32_t> sleeping; //< is the consumer waiting?
+		};
+		
+		/// map the segment, the ring bytes follow the header
+		bool map(int fd) {
+			void *memory = mmap(NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if(memory == MAP_FAILED) {
+				return false;
+			}
+			header = (Header *) memory;
+			data = (char *) memory + sizeof(Header);
+			return true;
+		}
+		
+		/// padded to 4 bytes
+		static uint32_t pad(uint32_t size) {return (size + 3) & ~3;}
+		
+		/// shm names start with a "/"
+		static std::string shmName(const std::string &name) {
+			return (!name.empty() && name[0] == '/') ? name : "/" + name;
+		}
+		
+		std::string name;
+		Header *header; //< NULL when closed
+		char *data; //< ring bytes
+		size_t mapSize;
+		uint32_t frontSize; //< bytes to release on pop()
+		bool bOwner; //< created the segment?
+};
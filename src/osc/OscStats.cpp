@@ -0,0 +1,152 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscStats.h"
+
+#include "OscHash.h"
+
+// default number of address segments in a prefix
+#define DEFAULT_DEPTH 3
+
+// max slots used before new prefixes go to "*", keeps probing short
+#define MAX_USED (NUM_SLOTS * 3 / 4)
+
+//--------------------------------------------------------------
+OscStats::OscStats() : bEnabled(false), bForwarded(false), depth(DEFAULT_DEPTH), numUsed(0),
+	lastSnapshotTime(oscMonotonicTime()) {
+	for(unsigned int i = 0; i <= NUM_SLOTS; ++i) {
+		slots[i].bUsed = false;
+		clearSlot(slots[i]);
+	}
+	strcpy(slots[NUM_SLOTS].prefix, "*");
+	slots[NUM_SLOTS].bUsed = true;
+}
+
+//--------------------------------------------------------------
+void OscStats::setDepth(unsigned int depth) {
+	this->depth = std::max(depth, 1u);
+	clear();
+}
+
+//--------------------------------------------------------------
+void OscStats::add(const string &address, bool handled, uint64_t time) {
+	Slot &slot = getSlot(address);
+	slot.count.fetch_add(1, std::memory_order_relaxed);
+	if(handled) {
+		slot.handled.fetch_add(1, std::memory_order_relaxed);
+	}
+	else if(bForwarded) {
+		slot.forwarded.fetch_add(1, std::memory_order_relaxed);
+	}
+	else {
+		slot.unhandled.fetch_add(1, std::memory_order_relaxed);
+	}
+	bForwarded = false;
+	slot.time.fetch_add(time, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------
+void OscStats::snapshot(vector<Snapshot> &snapshots) {
+	uint64_t now = oscMonotonicTime();
+	float seconds = (now - lastSnapshotTime) / 1000000.0f;
+	lastSnapshotTime = now;
+	snapshots.clear();
+	for(unsigned int i = 0; i <= NUM_SLOTS; ++i) {
+		Slot &slot = slots[i];
+		if(!slot.bUsed.load(std::memory_order_acquire)) {
+			continue;
+		}
+		Snapshot s;
+		s.count = slot.count.load(std::memory_order_relaxed);
+		if(s.count == 0) {
+			continue;
+		}
+		s.prefix = slot.prefix;
+		s.handled = slot.handled.load(std::memory_order_relaxed);
+		s.unhandled = slot.unhandled.load(std::memory_order_relaxed);
+		s.forwarded = slot.forwarded.load(std::memory_order_relaxed);
+		s.time = slot.time.load(std::memory_order_relaxed);
+		s.rate = seconds > 0 ? (s.count - slot.lastCount) / seconds : 0;
+		slot.lastCount = s.count;
+		snapshots.push_back(s);
+	}
+}
+
+//--------------------------------------------------------------
+void OscStats::clear() {
+	for(unsigned int i = 0; i < NUM_SLOTS; ++i) {
+		slots[i].bUsed.store(false, std::memory_order_release);
+		clearSlot(slots[i]);
+	}
+	clearSlot(slots[NUM_SLOTS]);
+	numUsed = 0;
+	lastSnapshotTime = oscMonotonicTime();
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+OscStats::Slot& OscStats::getSlot(const string &address) {
+	
+	// prefix length: up to the depth-th segment
+	unsigned int length = 0, segments = 0;
+	for(; length < address.size(); ++length) {
+		if(address[length] == '/' && length > 0 && ++segments == depth) {
+			break;
+		}
+	}
+	if(length > MAX_PREFIX_LENGTH) {
+		length = MAX_PREFIX_LENGTH;
+	}
+	
+	uint32_t hash = oscHashAddress(address.c_str(), length);
+	
+	// linear probe
+	for(unsigned int i = 0; i < NUM_SLOTS; ++i) {
+		Slot &slot = slots[(hash + i) & (NUM_SLOTS - 1)];
+		if(!slot.bUsed.load(std::memory_order_relaxed)) {
+			if(numUsed >= MAX_USED) {
+				break;
+			}
+			slot.hash = hash;
+			memcpy(slot.prefix, address.c_str(), length);
+			slot.prefix[length] = '\0';
+			slot.bUsed.store(true, std::memory_order_release);
+			numUsed++;
+			return slot;
+		}
+		if(slot.hash == hash && strncmp(slot.prefix, address.c_str(), length) == 0 &&
+		   slot.prefix[length] == '\0') {
+			return slot;
+		}
+	}
+	return slots[NUM_SLOTS];
+}
+
+//--------------------------------------------------------------
+void OscStats::clearSlot(Slot &slot) {
+	slot.count = 0;
+	slot.handled = 0;
+	slot.unhandled = 0;
+	slot.forwarded = 0;
+	slot.time = 0;
+	slot.lastCount = 0;
+}
@@ -0,0 +1,105 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscPacket.h"
+
+/// per address prefix message counts & handler time
+///
+/// counters live in a fixed number of slots found by hashing the prefix, so
+/// counting never allocates, & are relaxed atomics so a snapshot can be
+/// taken from any thread while messages are being counted
+///
+/// a prefix is the first few segments of an address, ie. "/visual/scene1/rect"
+/// for a depth of 3, prefixes which don't fit are counted together as "*"
+///
+/// note: only count from one thread
+class OscStats {
+
+	public:
+	
+		/// counters for a prefix at the time of a snapshot
+		struct Snapshot {
+			string prefix;
+			unsigned int count; //< messages
+			unsigned int handled; //< handled by an object
+			unsigned int unhandled; //< not handled by any object
+			unsigned int forwarded; //< not handled, passed on to a fallback, ie. lua
+			uint64_t time; //< cumulative handler time in microseconds
+			float rate; //< messages per second since the last snapshot
+		};
+	
+		OscStats();
+		
+		/// count messages? off by default
+		void setEnabled(bool enabled) {bEnabled = enabled; bForwarded = false;}
+		bool isEnabled() {return bEnabled;}
+		
+		/// set the number of address segments in a prefix, clears the counters
+		void setDepth(unsigned int depth);
+		unsigned int getDepth() {return depth;}
+		
+		/// count a dispatched message & how long it took to handle, counted
+		/// as forwarded instead of unhandled if forwarded() was called
+		void add(const string &address, bool handled, uint64_t time);
+		
+		/// mark the message being handled as passed on to a fallback which
+		/// may or may not use it, ie. the lua oscReceived callback, call from
+		/// the handler before returning false
+		void forwarded() {bForwarded = true;}
+		
+		/// get the counters for all prefixes seen so far,
+		/// rates are since the last snapshot
+		void snapshot(vector<Snapshot> &snapshots);
+		
+		/// clear all counters & prefixes, call from the counting thread
+		void clear();
+		
+		static const unsigned int NUM_SLOTS = 256;
+		static const unsigned int MAX_PREFIX_LENGTH = 63;
+	
+	protected:
+	
+		/// counters for a prefix
+		struct Slot {
+			std::atomic<bool> bUsed; //< set once the prefix is written
+			uint32_t hash;
+			char prefix[MAX_PREFIX_LENGTH+1];
+			std::atomic<unsigned int> count, handled, unhandled, forwarded;
+			std::atomic<uint64_t> time;
+			unsigned int lastCount; //< at the last snapshot
+		};
+		
+		/// find or claim the slot for an address prefix
+		Slot& getSlot(const string &address);
+		
+		/// reset a slot, does not touch bUsed
+		static void clearSlot(Slot &slot);
+	
+		bool bEnabled;
+		bool bForwarded; //< current message forwarded?
+		unsigned int depth;
+		Slot slots[NUM_SLOTS+1]; //< last is "*"
+		unsigned int numUsed;
+		uint64_t lastSnapshotTime;
+};
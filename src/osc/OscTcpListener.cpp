@@ -0,0 +1,299 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscTcpListener.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+// SLIP special bytes, RFC 1055
+#define SLIP_END     0300
+#define SLIP_ESC     0333
+#define SLIP_ESC_END 0334
+#define SLIP_ESC_ESC 0335
+
+// socket read size
+#define READ_BUFFER_SIZE 65536
+
+// how often the thread wakes to check if it should stop
+#define POLL_TIMEOUT_MS 100
+
+// how often the thread retries connections waiting for queue space
+#define WAITING_POLL_MS 1
+
+// set a socket to non-blocking
+static bool setNonBlocking(int socket) {
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) >= 0;
+}
+
+//--------------------------------------------------------------
+OscTcpListener::OscTcpListener(unsigned int port, const string &subtree) :
+	port(port), bListening(false), socket(-1), numConnections(0) {
+	setSubtree(subtree);
+	setMaxPacketSize(OSC_MAX_STREAM_PACKET_SIZE);
+}
+
+//--------------------------------------------------------------
+OscTcpListener::~OscTcpListener() {
+	stop();
+}
+
+//--------------------------------------------------------------
+bool OscTcpListener::start() {
+	if(bListening) {
+		ofLogWarning() << "OscTcpListener: already listening on " << port;
+		return false;
+	}
+	
+	socket = ::socket(AF_INET, SOCK_STREAM, 0);
+	if(socket < 0) {
+		ofLogError() << "OscTcpListener: couldn't create socket: " << strerror(errno);
+		return false;
+	}
+	int on = 1;
+	setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if(bind(socket, (struct sockaddr *) &address, sizeof(address)) < 0 ||
+	   listen(socket, SOMAXCONN) < 0 || !setNonBlocking(socket)) {
+		ofLogError() << "OscTcpListener: couldn't listen on port "
+			<< port << ": " << strerror(errno);
+		close(socket);
+		socket = -1;
+		return false;
+	}
+	
+	bListening = true;
+	startThread(false);
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscTcpListener::stop() {
+	if(!bListening) {
+		return;
+	}
+	waitForThread(true);
+	for(unsigned int i = 0; i < connections.size(); ++i) {
+		close(connections[i].socket);
+	}
+	connections.clear();
+	numConnections = 0;
+	close(socket);
+	socket = -1;
+	bListening = false;
+}
+
+//--------------------------------------------------------------
+bool OscTcpListener::setPort(unsigned int port) {
+	if(port == this->port) {
+		return true;
+	}
+	this->port = port;
+	if(bListening) {
+		stop();
+		return start();
+	}
+	return true;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscTcpListener::threadedFunction() {
+	vector<struct pollfd> fds;
+	buffer.resize(READ_BUFFER_SIZE);
+	
+	while(isThreadRunning()) {
+	
+		// retry connections waiting for queue space
+		bool bWaiting = false;
+		for(unsigned int i = 0; i < connections.size(); ++i) {
+			if(connections[i].bWaiting && !flushConnection(connections[i])) {
+				bWaiting = true;
+			}
+		}
+	
+		// listening socket first, then the connections, those still waiting
+		// aren't read so their data backs up in the socket
+		fds.resize(connections.size()+1);
+		fds[0].fd = socket;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		for(unsigned int i = 0; i < connections.size(); ++i) {
+			fds[i+1].fd = connections[i].bWaiting ? -1 : connections[i].socket;
+			fds[i+1].events = POLLIN;
+			fds[i+1].revents = 0;
+		}
+		
+		int ready = poll(&fds[0], fds.size(), bWaiting ? WAITING_POLL_MS : POLL_TIMEOUT_MS);
+		if(ready < 0) {
+			if(errno != EINTR) {
+				ofLogError() << "OscTcpListener: poll error: " << strerror(errno);
+				sleep(POLL_TIMEOUT_MS);
+			}
+			continue;
+		}
+		if(ready == 0) {
+			continue;
+		}
+		
+		// read connections before accepting as accepting changes the list,
+		// iterate backwards so closed connections can be removed in place
+		for(int i = (int) connections.size()-1; i >= 0; --i) {
+			if(fds[i+1].revents == 0) {
+				continue;
+			}
+			if(!readConnection(connections[i])) {
+				close(connections[i].socket);
+				connections.erase(connections.begin()+i);
+			}
+		}
+		if(fds[0].revents & POLLIN) {
+			acceptConnections();
+		}
+		numConnections = connections.size();
+	}
+}
+
+//--------------------------------------------------------------
+void OscTcpListener::acceptConnections() {
+	while(true) {
+		struct sockaddr_in address;
+		socklen_t length = sizeof(address);
+		int client = accept(socket, (struct sockaddr *) &address, &length);
+		if(client < 0) {
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				ofLogWarning() << "OscTcpListener: accept error: " << strerror(errno);
+			}
+			return;
+		}
+		if(!setNonBlocking(client)) {
+			close(client);
+			continue;
+		}
+		connections.push_back(Connection(client,
+			osc::IpEndpointName(ntohl(address.sin_addr.s_addr), ntohs(address.sin_port))));
+	}
+}
+
+//--------------------------------------------------------------
+bool OscTcpListener::readConnection(Connection &connection) {
+	if(!flushConnection(connection)) {
+		return true; // leave the rest in the socket
+	}
+	while(true) {
+		ssize_t count = recv(connection.socket, &buffer[0], buffer.size(), 0);
+		if(count == 0) {
+			return false; // closed by the client
+		}
+		if(count < 0) {
+			if(errno == EAGAIN || errno == EWOULDBLOCK) {
+				return true; // nothing left for now
+			}
+			if(errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		unsigned int used = decode(connection, &buffer[0], count);
+		if(connection.bWaiting) {
+			connection.unread.assign(buffer.begin()+used, buffer.begin()+count);
+			return true;
+		}
+	}
+}
+
+//--------------------------------------------------------------
+unsigned int OscTcpListener::decode(Connection &connection, const char *bytes, unsigned int count) {
+	
+	// SLIP decode, a frame is complete at each END
+	for(unsigned int i = 0; i < count; ++i) {
+		unsigned char c = bytes[i];
+		if(c == SLIP_END) {
+			if(connection.bOverflow) {
+				numReceived++;
+				numDropped++;
+			}
+			else if(!connection.frame.empty()) {
+				if(!canQueuePacket(connection.frame.size())) {
+					connection.bWaiting = true; // keep the frame
+					connection.bEscape = false;
+					return i+1;
+				}
+				queuePacket(&connection.frame[0], connection.frame.size(), connection.endpoint);
+			}
+			connection.frame.clear(); // keeps capacity
+			connection.bEscape = false;
+			connection.bOverflow = false;
+			continue;
+		}
+		if(connection.bEscape) {
+			if(c == SLIP_ESC_END) {
+				c = SLIP_END;
+			}
+			else if(c == SLIP_ESC_ESC) {
+				c = SLIP_ESC;
+			}
+			connection.bEscape = false;
+		}
+		else if(c == SLIP_ESC) {
+			connection.bEscape = true;
+			continue;
+		}
+		if(connection.frame.size() >= maxPacketSize) {
+			connection.bOverflow = true;
+			continue;
+		}
+		connection.frame.push_back(c);
+	}
+	return count;
+}
+
+//--------------------------------------------------------------
+bool OscTcpListener::flushConnection(Connection &connection) {
+	if(connection.bWaiting) {
+		if(!canQueuePacket(connection.frame.size())) {
+			return false;
+		}
+		queuePacket(&connection.frame[0], connection.frame.size(), connection.endpoint);
+		connection.frame.clear();
+		connection.bWaiting = false;
+	}
+	if(!connection.unread.empty()) {
+		unsigned int used = decode(connection, &connection.unread[0], connection.unread.size());
+		connection.unread.erase(connection.unread.begin(), connection.unread.begin()+used);
+		if(connection.bWaiting) {
+			return false;
+		}
+	}
+	return true;
+}
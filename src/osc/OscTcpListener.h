@@ -0,0 +1,99 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscListener.h"
+
+/// OSC 1.1 SLIP framed tcp OscListener
+///
+/// accepts any number of connections, all handled with non-blocking io on a
+/// single event loop thread, each connection has its own read & frame buffers
+///
+/// allows larger packets than udp, 1 MB by default, so it's suited to file
+/// loads, blob uploads, & cues which shouldn't be dropped
+///
+/// when the queue is full, a connection holds its complete frame & isn't read
+/// again until there's space, so tcp flow control slows the sender down
+/// instead of frames being dropped
+class OscTcpListener : public OscListener, protected ofThread {
+
+	public:
+	
+		OscTcpListener(unsigned int port=0, const string &subtree="");
+		virtual ~OscTcpListener();
+		
+		/// open, bind, & listen on the socket, then start the event loop thread
+		bool start();
+		
+		/// stop the event loop thread & close all connections
+		void stop();
+		
+		bool isListening() {return bListening;}
+		string getName() {return "tcp "+ofToString(port);}
+		
+		/// set the port, restarts if listening
+		bool setPort(unsigned int port);
+		unsigned int getPort() {return port;}
+		
+		/// number of open connections
+		unsigned int getNumConnections() {return numConnections;}
+	
+	protected:
+	
+		void threadedFunction();
+	
+		/// a client connection
+		struct Connection {
+			Connection(int socket, const osc::IpEndpointName &endpoint) :
+				socket(socket), endpoint(endpoint), bEscape(false), bOverflow(false),
+				bWaiting(false) {}
+			int socket;
+			osc::IpEndpointName endpoint;
+			vector<char> frame; //< current SLIP frame being decoded
+			bool bEscape; //< last byte was an escape?
+			bool bOverflow; //< current frame too big, drop it
+			bool bWaiting; //< frame complete, waiting for queue space
+			vector<char> unread; //< bytes read after the waiting frame
+		};
+		
+		/// accept waiting connections
+		void acceptConnections();
+		
+		/// read & decode waiting data, returns false if the connection closed
+		bool readConnection(Connection &connection);
+		
+		/// SLIP decode bytes & queue complete frames, stops after a frame
+		/// which can't be queued yet, returns the number of bytes used
+		unsigned int decode(Connection &connection, const char *bytes, unsigned int count);
+		
+		/// queue a waiting frame & decode the unread bytes after it,
+		/// returns false if still waiting for queue space
+		bool flushConnection(Connection &connection);
+	
+		unsigned int port;
+		bool bListening;
+		int socket; //< listening socket, -1 when closed
+		vector<Connection> connections; //< event loop thread only
+		vector<char> buffer; //< reused read buffer
+		std::atomic<unsigned int> numConnections;
+};
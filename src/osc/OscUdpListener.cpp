@@ -0,0 +1,255 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#include "OscUdpListener.h"
+
+#ifdef TARGET_LINUX
+	#include <sys/socket.h>
+	#include <netinet/in.h>
+	#include <arpa/inet.h>
+	#include <unistd.h>
+	#include <errno.h>
+#endif
+
+// default max datagrams per recvmmsg() call
+#define DEFAULT_BATCH_SIZE 32
+
+// how often the thread wakes to check if it should stop
+#define RECEIVE_TIMEOUT_MS 100
+
+//--------------------------------------------------------------
+OscUdpListener::OscUdpListener(unsigned int port, const string &subtree) :
+	port(port), bufferSize(0), batchSize(DEFAULT_BATCH_SIZE), bListening(false) {
+#ifdef TARGET_LINUX
+	socket = -1;
+#endif
+	setSubtree(subtree);
+}
+
+//--------------------------------------------------------------
+OscUdpListener::~OscUdpListener() {
+	stop();
+}
+
+//--------------------------------------------------------------
+bool OscUdpListener::setPort(unsigned int port) {
+	if(port == this->port) {
+		return true;
+	}
+	this->port = port;
+	if(bListening) {
+		stop();
+		return start();
+	}
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscUdpListener::setBatchSize(unsigned int size) {
+	if(bListening) {
+		ofLogWarning() << "OscUdpListener: can't set batch size while listening";
+		return;
+	}
+	batchSize = (size == 0 ? 1 : size);
+}
+
+#ifdef TARGET_LINUX
+
+//--------------------------------------------------------------
+bool OscUdpListener::start() {
+	if(bListening) {
+		ofLogWarning() << "OscUdpListener: already listening on " << port;
+		return false;
+	}
+	
+	socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+	if(socket < 0) {
+		ofLogError() << "OscUdpListener: couldn't create socket: " << strerror(errno);
+		return false;
+	}
+	
+	int on = 1;
+	setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if(setsockopt(socket, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0) {
+		ofLogWarning() << "OscUdpListener: socket drop count not available";
+	}
+	if(bufferSize > 0) {
+		int size = bufferSize;
+		if(setsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0) {
+			ofLogWarning() << "OscUdpListener: couldn't set receive buffer size "
+				<< bufferSize << ": " << strerror(errno);
+		}
+	}
+	
+	// wake up periodically so the thread can be stopped
+	struct timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = RECEIVE_TIMEOUT_MS * 1000;
+	setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	address.sin_port = htons(port);
+	if(bind(socket, (struct sockaddr *) &address, sizeof(address)) < 0) {
+		ofLogError() << "OscUdpListener: couldn't bind to port "
+			<< port << ": " << strerror(errno);
+		close(socket);
+		socket = -1;
+		return false;
+	}
+	
+	// the kernel doubles the requested size for bookkeeping
+	int size = 0;
+	socklen_t length = sizeof(size);
+	getsockopt(socket, SOL_SOCKET, SO_RCVBUF, &size, &length);
+	ofLogVerbose() << "OscUdpListener: port " << port
+		<< " receive buffer size " << size;
+	
+	bListening = true;
+	startThread(false);
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscUdpListener::stop() {
+	if(!bListening) {
+		return;
+	}
+	waitForThread(true);
+	close(socket);
+	socket = -1;
+	bListening = false;
+}
+
+// PROTECTED
+//--------------------------------------------------------------
+void OscUdpListener::threadedFunction() {
+	
+	// preallocated per datagram headers
+	vector<struct mmsghdr> messages(batchSize);
+	vector<struct iovec> buffers(batchSize);
+	vector<struct sockaddr_in> addresses(batchSize);
+	vector<OscPacket*> slots(batchSize);
+	unsigned int controlSize = CMSG_SPACE(sizeof(uint32_t));
+	vector<char> control(batchSize * controlSize);
+	
+	uint32_t socketDropped = 0;
+	
+	while(isThreadRunning()) {
+	
+		// read into free queue slots, anything past them is read & dropped
+		for(unsigned int i = 0; i < batchSize; ++i) {
+			slots[i] = queue.back(i);
+			OscPacket *packet = (slots[i] != NULL ? slots[i] : &scratch);
+			buffers[i].iov_base = packet->data;
+			buffers[i].iov_len = OSC_MAX_PACKET_SIZE;
+			struct msghdr &header = messages[i].msg_hdr;
+			header.msg_name = &addresses[i];
+			header.msg_namelen = sizeof(struct sockaddr_in);
+			header.msg_iov = &buffers[i];
+			header.msg_iovlen = 1;
+			header.msg_control = &control[i * controlSize];
+			header.msg_controllen = controlSize;
+			header.msg_flags = 0;
+		}
+		
+		// block for the first datagram, then take whatever else is waiting
+		int count = recvmmsg(socket, &messages[0], batchSize, MSG_WAITFORONE, NULL);
+		if(count < 0) {
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				ofLogError() << "OscUdpListener: receive error: " << strerror(errno);
+				sleep(RECEIVE_TIMEOUT_MS);
+			}
+			continue;
+		}
+		
+		// commit filled slots in order, closing any gaps left by drops
+		uint64_t time = oscMonotonicTime();
+		unsigned int filled = 0;
+		for(int i = 0; i < count; ++i) {
+			struct msghdr &header = messages[i].msg_hdr;
+			
+			// latest kernel drop count for the socket
+			for(struct cmsghdr *c = CMSG_FIRSTHDR(&header); c != NULL; c = CMSG_NXTHDR(&header, c)) {
+				if(c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+					memcpy(&socketDropped, CMSG_DATA(c), sizeof(uint32_t));
+				}
+			}
+		
+			numReceived++;
+			if(slots[i] == NULL || (header.msg_flags & MSG_TRUNC)) {
+				numDropped++;
+				continue;
+			}
+			OscPacket *packet = slots[filled];
+			if(packet != slots[i]) {
+				memcpy(packet->data, slots[i]->data, messages[i].msg_len);
+			}
+			packet->size = messages[i].msg_len;
+			packet->endpoint = osc::IpEndpointName(ntohl(addresses[i].sin_addr.s_addr),
+			                                        ntohs(addresses[i].sin_port));
+			packet->time = time;
+			filled++;
+		}
+		
+		// hand off to main thread
+		queue.push(filled);
+		numSocketDropped = socketDropped;
+	}
+}
+
+#else
+
+//--------------------------------------------------------------
+bool OscUdpListener::start() {
+	if(bListening) {
+		ofLogWarning() << "OscUdpListener: already listening on " << port;
+		return false;
+	}
+	if(bufferSize > 0) {
+		ofLogWarning() << "OscUdpListener: receive buffer size ignored, linux only";
+	}
+	receiver = ofPtr<Receiver>(new Receiver);
+	receiver->listener = this;
+	receiver->setup(port);
+	bListening = true;
+	return true;
+}
+
+//--------------------------------------------------------------
+void OscUdpListener::stop() {
+	if(!bListening) {
+		return;
+	}
+	receiver.reset(); // joins the listening thread
+	bListening = false;
+}
+
+//--------------------------------------------------------------
+void OscUdpListener::Receiver::ProcessPacket(const char *data, int size,
+                                             const osc::IpEndpointName& remoteEndpoint) {
+	listener->queuePacket(data, size, remoteEndpoint);
+}
+
+#endif
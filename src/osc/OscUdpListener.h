@@ -0,0 +1,89 @@
+/*==============================================================================
+
+	Visual: a simple, osc-controlled graphics & scripting engine
+  
+	Copyright (c) 2013 Dan Wilcox <danomatika@gmail.com>
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+	
+	See https://github.com/danomatika/Visual for documentation
+
+==============================================================================*/
+#pragma once
+
+#include "OscListener.h"
+
+/// udp OscListener
+///
+/// on linux, uses recvmmsg() to read up to the batch size of datagrams per
+/// syscall straight into the preallocated queue slots & reads the kernel
+/// socket drop count via SO_RXQ_OVFL, elsewhere uses an ofxOscReceiver
+class OscUdpListener : public OscListener
+#ifdef TARGET_LINUX
+	, protected ofThread
+#endif
+{
+
+	public:
+	
+		OscUdpListener(unsigned int port=0, const string &subtree="");
+		virtual ~OscUdpListener();
+		
+		/// open & bind the socket, then start the listening thread
+		bool start();
+		
+		/// stop the listening thread & close the socket
+		void stop();
+		
+		bool isListening() {return bListening;}
+		string getName() {return "udp "+ofToString(port);}
+		
+		/// set the port, restarts if listening
+		bool setPort(unsigned int port);
+		unsigned int getPort() {return port;}
+		
+		/// set the socket receive buffer size in bytes, 0 for the system
+		/// default, used on the next start (linux only)
+		void setBufferSize(unsigned int size) {bufferSize = size;}
+		unsigned int getBufferSize() {return bufferSize;}
+		
+		/// max datagrams read per syscall, set before start (linux only)
+		void setBatchSize(unsigned int size);
+		unsigned int getBatchSize() {return batchSize;}
+		
+	protected:
+	
+		unsigned int port;
+		unsigned int bufferSize;
+		unsigned int batchSize;
+		bool bListening;
+	
+	#ifdef TARGET_LINUX
+		void threadedFunction();
+	
+		int socket; //< -1 when closed
+		OscPacket scratch; //< sink for datagrams which don't fit in the queue
+	#else
+		/// wrapper to override and queue raw packets
+		class Receiver : public ofxOscReceiver {
+			public:
+				Receiver() : ofxOscReceiver(), listener(NULL) {}
+				OscUdpListener *listener;
+				void ProcessPacket(const char *data, int size,
+					const osc::IpEndpointName& remoteEndpoint);
+		};
+		friend Receiver;
+		ofPtr<Receiver> receiver;
+	#endif
+};